@@ -0,0 +1,419 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <stdexcept>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * 06_chrome_trace_spans.cpp
+ *
+ * PURPOSE: Timeline instrumentation for the lambda patterns of this project:
+ *   - pipeline stages   (filter -> square -> sum from 03_lambda_evolution_demo.cpp)
+ *   - pool tasks        (lambdas pushed into a std::function task queue)
+ *   - event dispatch    (Foo::process-style callbacks from 04_lambda_replace_bind.cpp)
+ *
+ * DESIGN:
+ *   - A span is two timestamp reads plus ONE 24-byte store, no locks, no allocation.
+ *   - Each thread owns a ring buffer (single writer). The only shared write is
+ *     a release-store of the ring's head index, so producers never contend.
+ *   - Buffers outlive their threads; export() walks all of them and writes
+ *     Chrome trace-event JSON ("ph":"X" complete events) that opens directly in
+ *     https://ui.perfetto.dev or chrome://tracing.
+ *   - Timestamps come from the TSC on x86 (calibrated once against
+ *     steady_clock), steady_clock elsewhere.
+ *   - When a ring is full the oldest spans are overwritten; the exporter
+ *     reports how many were lost.
+ *
+ * Export is meant for quiescent points (after the workers joined or between
+ * batches); spans written while exporting may be skipped.
+ *
+ * Build: g++ -std=c++14 -O2 -pthread 06_chrome_trace_spans.cpp -o 06_trace_cpp14
+ * Run:   ./06_trace_cpp14 [trace.json]
+ */
+
+namespace trace {
+
+// ===== Clock =====
+inline std::uint64_t now_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Ticks per microsecond, measured once against steady_clock
+inline double ticks_per_us() {
+    static const double value = [] {
+        auto t0 = std::chrono::steady_clock::now();
+        std::uint64_t c0 = now_ticks();
+        while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(20)) {
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        std::uint64_t c1 = now_ticks();
+        double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+        return static_cast<double>(c1 - c0) / us;
+    }();
+    return value;
+}
+
+// ===== Per-thread ring =====
+struct Record {
+    const char* name;         // Must point to a string literal (stored, not copied)
+    std::uint64_t start;
+    std::uint32_t duration;   // ticks; spans longer than ~1s at 4 GHz are clamped
+    std::int32_t arg;         // Free-form integer shown in the Perfetto "args" panel
+};
+
+class ThreadBuffer {
+public:
+    static constexpr std::size_t capacity = 1u << 16;   // 1.5 MB per thread
+
+    ThreadBuffer(int tid, std::string name) : tid_(tid), name_(std::move(name)), records_(capacity) {}
+
+    void push(const char* name, std::uint64_t start, std::uint64_t end, std::int32_t arg) {
+        const std::uint64_t h = head_.load(std::memory_order_relaxed);
+        const std::uint64_t d = end - start;
+        records_[h & (capacity - 1)] = Record{name, start, d > UINT32_MAX ? UINT32_MAX : static_cast<std::uint32_t>(d), arg};
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    // Copies the live window of the ring; returns the number of overwritten spans
+    std::uint64_t snapshot(std::vector<Record>& out) const {
+        const std::uint64_t h = head_.load(std::memory_order_acquire);
+        const std::uint64_t first = h > capacity ? h - capacity : 0;
+        for (std::uint64_t i = first; i < h; ++i) out.push_back(records_[i & (capacity - 1)]);
+        return first;
+    }
+
+    void clear() { head_.store(0, std::memory_order_release); }
+
+    int tid() const { return tid_; }
+    const std::string& name() const { return name_; }
+
+private:
+    int tid_;
+    std::string name_;
+    std::vector<Record> records_;
+    std::atomic<std::uint64_t> head_{0};
+};
+
+// Owns every thread's buffer; the mutex is only taken on a thread's first span
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadBuffer* create(std::string name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers_.push_back(std::unique_ptr<ThreadBuffer>(
+            new ThreadBuffer(static_cast<int>(buffers_.size()) + 1, std::move(name))));
+        return buffers_.back().get();
+    }
+
+    template <typename F>
+    void for_each(F&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& buffer : buffers_) fn(*buffer);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+inline ThreadBuffer*& current_slot() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    return buffer;
+}
+
+// Optional: name the calling thread before its first span ("pool-worker-2", ...)
+inline void set_thread_name(const std::string& name) {
+    current_slot() = Registry::instance().create(name);
+}
+
+inline ThreadBuffer& current() {
+    ThreadBuffer*& slot = current_slot();
+    if (!slot) slot = Registry::instance().create("thread");
+    return *slot;
+}
+
+// ===== Spans =====
+class Span {
+public:
+    explicit Span(const char* name, std::int32_t arg = 0)
+        : buffer_(current()), name_(name), arg_(arg), start_(now_ticks()) {}
+    ~Span() { buffer_.push(name_, start_, now_ticks(), arg_); }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    ThreadBuffer& buffer_;
+    const char* name_;
+    std::int32_t arg_;
+    std::uint64_t start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(...) ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+
+// Wrap any callable so every invocation becomes a span:
+//   auto square = trace::traced("stage:square", [](int x) { return x * x; });
+template <typename F>
+auto traced(const char* name, F fn) {
+    return [name, fn](auto&&... args) -> decltype(auto) {
+        Span span(name);
+        return fn(std::forward<decltype(args)>(args)...);
+    };
+}
+
+// Drop everything recorded so far (e.g. after a warm-up or overhead benchmark)
+inline void reset() {
+    Registry::instance().for_each([](ThreadBuffer& b) { b.clear(); });
+}
+
+inline void write_json_string(std::ostream& os, const std::string& s) {
+    os << '"';
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') os << '\\';
+        os << ch;
+    }
+    os << '"';
+}
+
+// Writes Chrome trace-event JSON; returns the number of spans written
+inline std::size_t export_chrome_trace(const std::string& path, std::uint64_t* lost = nullptr) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("cannot open " + path);
+
+    const double tpu = ticks_per_us();
+    std::vector<Record> records;
+    std::uint64_t min_start = UINT64_MAX;
+    std::uint64_t overwritten = 0;
+    std::size_t written = 0;
+
+    struct ThreadView { int tid; std::string name; std::vector<Record> records; };
+    std::vector<ThreadView> threads;
+    Registry::instance().for_each([&](const ThreadBuffer& b) {
+        ThreadView view{b.tid(), b.name(), {}};
+        overwritten += b.snapshot(view.records);
+        for (const Record& r : view.records) min_start = std::min(min_start, r.start);
+        threads.push_back(std::move(view));
+    });
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&] { if (!first) out << ",\n"; first = false; };
+    out << std::fixed << std::setprecision(3);
+    for (const ThreadView& t : threads) {
+        separator();
+        out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << t.tid << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        write_json_string(out, t.name);
+        out << "}}";
+        for (const Record& r : t.records) {
+            separator();
+            out << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << t.tid << ",\"name\":";
+            write_json_string(out, r.name);
+            out << ",\"ts\":" << (r.start - min_start) / tpu << ",\"dur\":" << r.duration / tpu
+                << ",\"args\":{\"arg\":" << r.arg << "}}";
+            ++written;
+        }
+    }
+    out << "\n]}\n";
+    if (lost) *lost = overwritten;
+    return written;
+}
+
+}  // namespace trace
+
+// ===== Instrumented workload =====
+
+// Task queue from the production use case: lambdas in a std::function queue
+class TaskPool {
+public:
+    explicit TaskPool(std::size_t workers) {
+        for (std::size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i] {
+                trace::set_thread_name("pool-worker-" + std::to_string(i));
+                run();
+            });
+        }
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            TRACE_SPAN("pool:enqueue");
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        ready_.notify_one();
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                TRACE_SPAN("pool:wait");
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            TRACE_SPAN("pool:task");
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+struct Foo {
+    std::atomic<long long> processed{0};
+    void process(const std::string& data) { processed += static_cast<long long>(data.size()); }
+};
+
+// One batch of the 03 pipeline, every stage a span
+long long run_pipeline_batch(const std::vector<int>& data, int batch) {
+    TRACE_SPAN("pipeline:batch", batch);
+    auto is_positive = [](int x) { return x > 0; };
+    auto square = [](int x) { return x * x; };
+
+    std::vector<int> positives;
+    {
+        TRACE_SPAN("stage:filter", batch);
+        std::copy_if(data.begin(), data.end(), std::back_inserter(positives), is_positive);
+    }
+    std::vector<long long> squared(positives.size());
+    {
+        TRACE_SPAN("stage:square", batch);
+        std::transform(positives.begin(), positives.end(), squared.begin(), square);
+    }
+    TRACE_SPAN("stage:sum", batch);
+    return std::accumulate(squared.begin(), squared.end(), 0LL);
+}
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+void benchmark_span_cost() {
+    section_header("Span cost (single thread, 10M spans)");
+    const int iterations = 10000000;
+    std::atomic<long long> sink{0};
+
+    auto measure = [&](auto&& body) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) body(i);
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+    };
+
+    double empty = measure([&](int i) { sink.fetch_add(i, std::memory_order_relaxed); });
+    double span = measure([&](int i) {
+        TRACE_SPAN("bench:span", i);
+        sink.fetch_add(i, std::memory_order_relaxed);
+    });
+    double clock_read = measure([&](int i) {
+        sink.fetch_add(static_cast<long long>(trace::now_ticks()) + i, std::memory_order_relaxed);
+    });
+    double chrono_pair = measure([&](int i) {
+        auto a = std::chrono::steady_clock::now();
+        sink.fetch_add(i, std::memory_order_relaxed);
+        auto b = std::chrono::steady_clock::now();
+        sink.fetch_add((b - a).count(), std::memory_order_relaxed);
+    });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Loop body only:            " << std::setw(7) << empty << " ns/iter\n";
+    std::cout << "  + TRACE_SPAN:              " << std::setw(7) << span << " ns/iter  -> "
+              << span - empty << " ns per span " << (span - empty < 20.0 ? "(✅ < 20 ns)" : "(⚠️ over 20 ns budget)") << '\n';
+    std::cout << "  + one now_ticks() read:    " << std::setw(7) << clock_read << " ns/iter  -> span floor is 2 x "
+              << clock_read - empty << " ns (virtualized TSC reads are slower)\n";
+    std::cout << "  + steady_clock::now() x2:  " << std::setw(7) << chrono_pair << " ns/iter  (for comparison)\n";
+    std::cout << "  TSC ticks per microsecond: " << trace::ticks_per_us() << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    const std::string path = argc > 1 ? argv[1] : "lambda_trace.json";
+
+    std::cout << "Chrome-Trace Timeline for Lambda Pipelines, Tasks and Events\n";
+    std::cout << "============================================================\n";
+
+    trace::set_thread_name("main");
+    benchmark_span_cost();
+    trace::reset();   // Keep the overhead benchmark out of the exported timeline
+
+    section_header("Instrumented workload");
+    std::vector<int> data(1 << 16);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    for (int& x : data) x = dist(rng);
+
+    std::atomic<long long> total{0};
+    Foo foo;
+    {
+        TaskPool pool(4);
+
+        // Pipeline batches as pool tasks
+        for (int batch = 0; batch < 32; ++batch) {
+            pool.submit([&data, &total, batch] { total += run_pipeline_batch(data, batch); });
+        }
+
+        // Event dispatch: the 04 callback, wrapped once with traced()
+        auto on_event = trace::traced("event:dispatch", [&foo](const std::string& e) { foo.process(e); });
+        std::vector<std::string> events = {"event1", "event2", "event3"};
+        for (int round = 0; round < 1000; ++round) {
+            for (const auto& e : events) on_event(e);
+        }
+    }   // Pool joins here: every ring is quiescent before export
+
+    std::uint64_t lost = 0;
+    std::size_t spans = trace::export_chrome_trace(path, &lost);
+
+    std::cout << "  Pipeline total: " << total << '\n';
+    std::cout << "  Events processed (bytes): " << foo.processed << '\n';
+    std::cout << "  Wrote " << spans << " spans to " << path << " (" << lost << " overwritten in full rings)\n";
+    std::cout << "  Open it in https://ui.perfetto.dev or chrome://tracing\n";
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ TRACE_SPAN / trace::traced() wrap stages, tasks and callbacks without changing them\n";
+    std::cout << "  ✅ Per-thread rings: producers share no cache lines and take no locks\n";
+    std::cout << "  ✅ Stalls show up as gaps or long pool:wait spans on the worker tracks\n";
+    return 0;
+}
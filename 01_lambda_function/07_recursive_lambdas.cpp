@@ -0,0 +1,272 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+/**
+ * 07_recursive_lambdas.cpp
+ *
+ * PURPOSE: Recursive lambdas without paying std::function type erasure on
+ * every recursive call.
+ *
+ * THE USUAL WAY (C++11):
+ *   std::function<int(int)> fib = [&fib](int n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); };
+ *   -> every recursive call goes through an indirect call the optimizer cannot see through
+ *   -> the closure captures the std::function by reference (dangles if fib is returned)
+ *
+ * C++14: fix / y_combinator
+ *   auto fib = fix([](const auto& self, int n) -> int { return n < 2 ? n : self(n - 1) + self(n - 2); });
+ *   -> the lambda receives ITSELF as the first argument; every call is a direct,
+ *      inlinable call on a concrete type. Note the explicit "-> int": the
+ *      compiler must know the return type before it sees the recursive call.
+ *
+ * C++23: deducing this
+ *   auto fib = [](this const auto& self, int n) -> int { ... self(n - 1) ... };
+ *   -> same code generation without the helper (compiled when the compiler
+ *      defines __cpp_explicit_this_parameter).
+ *
+ * MEMOIZATION: memo_fix<R(Args...)>(lambda) caches results per argument tuple,
+ * so the recursive calls made through `self` hit the cache too.
+ *
+ * Build: g++ -std=c++14 -O2 07_recursive_lambdas.cpp -o 07_recursive_cpp14
+ *        g++ -std=c++23 -O2 07_recursive_lambdas.cpp -o 07_recursive_cpp23   # GCC 14+ / Clang 18+
+ */
+
+// ===== fix / y_combinator (C++14) =====
+template <typename F>
+class y_combinator {
+public:
+    explicit y_combinator(F f) : f_(std::move(f)) {}
+
+    template <typename... Args>
+    decltype(auto) operator()(Args&&... args) const {
+        return f_(*this, std::forward<Args>(args)...);
+    }
+
+private:
+    F f_;
+};
+
+template <typename F>
+y_combinator<std::decay_t<F>> fix(F&& f) {
+    return y_combinator<std::decay_t<F>>(std::forward<F>(f));
+}
+
+// ===== Memoized fix =====
+template <typename F, typename Signature>
+class memoized;
+
+template <typename F, typename R, typename... Args>
+class memoized<F, R(Args...)> {
+public:
+    explicit memoized(F f) : f_(std::move(f)) {}
+
+    R operator()(Args... args) const {
+        auto key = std::make_tuple(args...);
+        auto it = cache_.find(key);
+        if (it != cache_.end()) return it->second;
+        R result = f_(*this, args...);
+        cache_.emplace(std::move(key), result);
+        return result;
+    }
+
+    std::size_t cache_size() const { return cache_.size(); }
+
+private:
+    F f_;
+    mutable std::map<std::tuple<std::decay_t<Args>...>, R> cache_;
+};
+
+// Usage: auto fib = memo_fix<long long(int)>([](const auto& self, int n) -> long long { ... });
+template <typename Signature, typename F>
+memoized<std::decay_t<F>, Signature> memo_fix(F&& f) {
+    return memoized<std::decay_t<F>, Signature>(std::forward<F>(f));
+}
+
+// ===== Workloads =====
+struct Node {
+    int value;
+    int left;    // -1 = none
+    int right;
+};
+
+// Complete binary tree stored in a vector (node i has children 2i+1, 2i+2)
+std::vector<Node> build_tree(int depth) {
+    const int count = (1 << depth) - 1;
+    std::vector<Node> tree(count);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> dist(-100, 100);
+    for (int i = 0; i < count; ++i) {
+        int l = 2 * i + 1, r = 2 * i + 2;
+        tree[i] = Node{dist(rng), l < count ? l : -1, r < count ? r : -1};
+    }
+    return tree;
+}
+
+int fib_function(int n) { return n < 2 ? n : fib_function(n - 1) + fib_function(n - 2); }
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+struct Row {
+    std::string name;
+    double ms;
+    long long result;
+};
+
+void print_rows(const std::vector<Row>& rows) {
+    const double baseline = rows.front().ms;
+    for (const auto& row : rows) {
+        std::cout << "  " << std::left << std::setw(40) << row.name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(10) << row.ms << " ms"
+                  << std::setprecision(2) << std::setw(9) << baseline / row.ms << "x"
+                  << "   result " << row.result << '\n';
+    }
+}
+
+void demonstrate_syntax() {
+    section_header("Three ways to write a recursive lambda");
+
+    // C++11: std::function captured by reference
+    std::function<int(int)> fib11 = [&fib11](int n) -> int { return n < 2 ? n : fib11(n - 1) + fib11(n - 2); };
+    std::cout << "  C++11 std::function:  fib(20) = " << fib11(20) << '\n';
+
+    // C++14: fix
+    auto fib14 = fix([](const auto& self, int n) -> int { return n < 2 ? n : self(n - 1) + self(n - 2); });
+    std::cout << "  C++14 fix(...):       fib(20) = " << fib14(20) << '\n';
+
+#if defined(__cpp_explicit_this_parameter)
+    auto fib23 = [](this const auto& self, int n) -> int { return n < 2 ? n : self(n - 1) + self(n - 2); };
+    std::cout << "  C++23 deducing this:  fib(20) = " << fib23(20) << '\n';
+#else
+    std::cout << "  C++23 deducing this:  not supported by this compiler/standard\n";
+    std::cout << "    // auto fib = [](this const auto& self, int n) -> int { ... self(n - 1) ... };\n";
+#endif
+
+    // Memoized: exponential -> linear
+    auto fib_memo = memo_fix<long long(int)>([](const auto& self, int n) -> long long {
+        return n < 2 ? n : self(n - 1) + self(n - 2);
+    });
+    std::cout << "  memo_fix:             fib(90) = " << fib_memo(90) << "  (" << fib_memo.cache_size()
+              << " cached entries)\n";
+
+    // fix is a value: safe to return from a function, unlike the [&fib11] closure
+    auto make_counter = [] {
+        return fix([](const auto& self, int n, int acc) -> int { return n == 0 ? acc : self(n - 1, acc + 1); });
+    };
+    std::cout << "  fix returned by value: count(1000) = " << make_counter()(1000, 0) << '\n';
+}
+
+void benchmark_recursion() {
+    section_header("BENCHMARK: naive Fibonacci(32)  (~7M calls)");
+    {
+        volatile int n = 32;   // Re-read every run: keeps the optimizer from folding or hoisting the recursion
+        long long result = 0;
+        std::vector<Row> rows;
+
+        std::function<int(int)> fib_fn = [&fib_fn](int k) -> int { return k < 2 ? k : fib_fn(k - 1) + fib_fn(k - 2); };
+        rows.push_back({"std::function recursion", time_ms([&] { result = fib_fn(n); }), result});
+
+        auto fib_fix = fix([](const auto& self, int k) -> int { return k < 2 ? k : self(k - 1) + self(k - 2); });
+        rows.push_back({"fix / y_combinator", time_ms([&] { result = fib_fix(n); }), result});
+
+#if defined(__cpp_explicit_this_parameter)
+        auto fib23 = [](this const auto& self, int k) -> int { return k < 2 ? k : self(k - 1) + self(k - 2); };
+        rows.push_back({"C++23 deducing this", time_ms([&] { result = fib23(n); }), result});
+#endif
+
+        rows.push_back({"plain function (reference)", time_ms([&] { result = fib_function(n); }), result});
+
+        auto fib_body = [](const auto& self, int k) -> long long { return k < 2 ? k : self(k - 1) + self(k - 2); };
+        rows.push_back({"memo_fix (fresh cache each run)", time_ms([&] {
+            auto fib_memo = memo_fix<long long(int)>(fib_body);
+            result = fib_memo(n);
+        }), result});
+        print_rows(rows);
+        std::cout << "  (fix inlines several recursion levels; GCC then merges the duplicated pure calls)\n";
+    }
+
+    section_header("BENCHMARK: tree walk (sum of 2^20 - 1 nodes, depth 20)");
+    {
+        const std::vector<Node> tree = build_tree(20);
+        long long result = 0;
+        std::vector<Row> rows;
+
+        std::function<long long(int)> walk_fn = [&](int i) -> long long {
+            if (i < 0) return 0;
+            return tree[i].value + walk_fn(tree[i].left) + walk_fn(tree[i].right);
+        };
+        rows.push_back({"std::function recursion", time_ms([&] { result = walk_fn(0); }), result});
+
+        auto walk_fix = fix([&tree](const auto& self, int i) -> long long {
+            if (i < 0) return 0;
+            return tree[i].value + self(tree[i].left) + self(tree[i].right);
+        });
+        rows.push_back({"fix / y_combinator", time_ms([&] { result = walk_fix(0); }), result});
+
+#if defined(__cpp_explicit_this_parameter)
+        auto walk23 = [&tree](this const auto& self, int i) -> long long {
+            if (i < 0) return 0;
+            return tree[i].value + self(tree[i].left) + self(tree[i].right);
+        };
+        rows.push_back({"C++23 deducing this", time_ms([&] { result = walk23(0); }), result});
+#endif
+        print_rows(rows);
+    }
+
+    section_header("BENCHMARK: deep linear recursion (depth 10,000 x 1,000 runs)");
+    {
+        volatile int depth = 10000;
+        long long result = 0;
+        std::vector<Row> rows;
+
+        std::function<long long(int)> sum_fn = [&sum_fn](int k) -> long long { return k == 0 ? 0 : k + sum_fn(k - 1); };
+        rows.push_back({"std::function recursion", time_ms([&] {
+            for (int r = 0; r < 1000; ++r) result = sum_fn(depth);
+        }), result});
+
+        auto sum_fix = fix([](const auto& self, int k) -> long long { return k == 0 ? 0 : k + self(k - 1); });
+        rows.push_back({"fix / y_combinator", time_ms([&] {
+            for (int r = 0; r < 1000; ++r) result = sum_fix(depth);
+        }), result});
+        print_rows(rows);
+        std::cout << "  (fix is transparent to the optimizer, which may turn this recursion into a loop)\n";
+    }
+}
+
+int main() {
+    std::cout << "Recursive Lambdas without std::function\n";
+    std::cout << "=======================================\n";
+
+    demonstrate_syntax();
+    benchmark_recursion();
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ fix(lambda) passes the lambda to itself: direct, inlinable recursive calls\n";
+    std::cout << "  ✅ Needs an explicit return type on the lambda (-> int)\n";
+    std::cout << "  ✅ C++23 deducing this removes the helper entirely\n";
+    std::cout << "  ✅ memo_fix caches every recursive call, turning exponential recursions linear\n";
+    std::cout << "  ⚠️ std::function recursion also dangles if the closure outlives the std::function it captured\n";
+    return 0;
+}
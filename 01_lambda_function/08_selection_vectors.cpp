@@ -0,0 +1,295 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * 08_selection_vectors.cpp
+ *
+ * PURPOSE: A vectorized-engine execution mode for the filter -> square -> sum
+ * pipeline of 03_lambda_evolution_demo.cpp.
+ *
+ * C++11 pipeline (03):                 Selection-vector pipeline (this file):
+ *   copy_if(data -> positives)           for each batch of 2048 values:
+ *   transform(positives -> squared)        filter  -> uint16 selection vector / bitmap
+ *   accumulate(squared)                    square + sum read data[sel[i]] in place
+ *   = two heap vectors, 3 passes           = no copies, data stays in L1 per batch
+ *
+ * Three consumers of the filter result are compared:
+ *   - selection vector: branch-free build  sel[n] = i; n += pred(x[i]);
+ *     then downstream lambdas run only on x[sel[0..n)]
+ *   - bitmap + ctz:     one bit per row, downstream walks the set bits
+ *   - bitmap dense:     downstream runs on EVERY lane and masks the result,
+ *                       which vectorizes and wins when most rows survive
+ * and run_pipeline(Mode::Adaptive) picks between sparse and dense per batch.
+ *
+ * Build: g++ -std=c++14 -O2 08_selection_vectors.cpp -o 08_selvec_cpp14
+ * Run:   ./08_selvec_cpp14 [elements]
+ */
+
+namespace engine {
+
+constexpr std::size_t kBatch = 2048;   // 1024..4096 all fit uint16 indices and L1
+static_assert(kBatch <= 65536, "selection indices are uint16");
+constexpr std::size_t kWords = kBatch / 64;
+
+struct SelectionVector {
+    std::uint16_t index[kBatch];
+    std::size_t count = 0;
+};
+
+struct Bitmap {
+    std::uint64_t words[kWords];
+};
+
+// ===== Filters =====
+// Branch-free: always store, advance only when the predicate holds
+template <typename Pred>
+void select(const int* batch, std::size_t n, Pred pred, SelectionVector& sel) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sel.index[count] = static_cast<std::uint16_t>(i);
+        count += pred(batch[i]) ? 1 : 0;
+    }
+    sel.count = count;
+}
+
+// Chained filter: narrows an existing selection without touching rejected rows
+template <typename Pred>
+void refine(const int* batch, Pred pred, SelectionVector& sel) {
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < sel.count; ++k) {
+        const std::uint16_t i = sel.index[k];
+        sel.index[count] = i;
+        count += pred(batch[i]) ? 1 : 0;
+    }
+    sel.count = count;
+}
+
+// Predicate results land in a byte array first (a plain compare loop the
+// compiler vectorizes), then every 8 flags are packed into one bitmap byte
+inline std::uint64_t pack_flags(const std::uint8_t* flags) {
+    std::uint64_t word = 0;
+    for (int k = 0; k < 8; ++k) {
+        std::uint64_t bytes;
+        std::memcpy(&bytes, flags + 8 * k, 8);
+        word |= ((bytes * 0x0102040810204080ULL) >> 56) << (8 * k);   // byte b (0/1) -> bit b
+    }
+    return word;
+}
+
+template <typename Pred>
+std::size_t select_bitmap(const int* batch, std::size_t n, Pred pred, Bitmap& bits) {
+    std::uint8_t flags[kBatch];
+    if (n == kBatch) {
+        // Constant trip count: vectorized even under -O2's very-cheap cost model
+        for (std::size_t i = 0; i < kBatch; ++i) flags[i] = pred(batch[i]) ? 1 : 0;   // must-vectorize
+    } else {
+        for (std::size_t i = 0; i < n; ++i) flags[i] = pred(batch[i]) ? 1 : 0;
+        std::fill(flags + n, flags + kBatch, std::uint8_t{0});
+    }
+
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < kWords; ++w) {
+        bits.words[w] = pack_flags(flags + 64 * w);
+        count += static_cast<std::size_t>(__builtin_popcountll(bits.words[w]));
+    }
+    return count;
+}
+
+// ===== Consumers =====
+template <typename Fn>
+long long sum_selected(const int* batch, const SelectionVector& sel, Fn fn) {
+    long long sum = 0;
+    for (std::size_t k = 0; k < sel.count; ++k) sum += fn(batch[sel.index[k]]);
+    return sum;
+}
+
+template <typename Fn>
+long long sum_bitmap_sparse(const int* batch, const Bitmap& bits, Fn fn) {
+    long long sum = 0;
+    for (std::size_t w = 0; w < kWords; ++w) {
+        std::uint64_t word = bits.words[w];
+        while (word) {
+            const int j = __builtin_ctzll(word);
+            sum += fn(batch[w * 64 + j]);
+            word &= word - 1;
+        }
+    }
+    return sum;
+}
+
+// Computes fn on every lane and masks: no data-dependent branches. Reads the
+// bitmap one byte (8 lanes) at a time so the lane loop has a fixed trip count
+template <typename Fn>
+long long sum_bitmap_dense(const int* batch, std::size_t n, const Bitmap& bits, Fn fn) {
+    const std::uint8_t* mask = reinterpret_cast<const std::uint8_t*>(bits.words);   // little-endian
+    long long sum = 0;
+    for (std::size_t base = 0; base < n; base += 8) {
+        const std::uint8_t m = mask[base / 8];
+        if (base + 8 <= n) {
+            for (int j = 0; j < 8; ++j) {
+                const long long keep = -static_cast<long long>((m >> j) & 1);
+                sum += keep & static_cast<long long>(fn(batch[base + j]));
+            }
+        } else {
+            for (std::size_t j = 0; base + j < n; ++j) {
+                if ((m >> j) & 1) sum += fn(batch[base + j]);
+            }
+        }
+    }
+    return sum;
+}
+
+enum class Mode { SelectionVector, BitmapSparse, BitmapDense, Adaptive };
+
+// filter(pred) -> map(fn) -> sum, one batch at a time, nothing materialized
+template <typename Pred, typename Fn>
+long long run_pipeline(const std::vector<int>& data, Pred pred, Fn fn, Mode mode) {
+    SelectionVector sel;
+    Bitmap bits;
+    long long total = 0;
+    for (std::size_t start = 0; start < data.size(); start += kBatch) {
+        const int* batch = data.data() + start;
+        const std::size_t n = std::min(kBatch, data.size() - start);
+        switch (mode) {
+        case Mode::SelectionVector:
+            select(batch, n, pred, sel);
+            total += sum_selected(batch, sel, fn);
+            break;
+        case Mode::BitmapSparse:
+            select_bitmap(batch, n, pred, bits);
+            total += sum_bitmap_sparse(batch, bits, fn);
+            break;
+        case Mode::BitmapDense:
+            select_bitmap(batch, n, pred, bits);
+            total += sum_bitmap_dense(batch, n, bits, fn);
+            break;
+        case Mode::Adaptive: {
+            // Dense pays for every lane; sparse pays per survivor plus a branch miss
+            const std::size_t survivors = select_bitmap(batch, n, pred, bits);
+            total += survivors * 4 > n ? sum_bitmap_dense(batch, n, bits, fn)
+                                       : sum_bitmap_sparse(batch, bits, fn);
+            break;
+        }
+        }
+    }
+    return total;
+}
+
+}  // namespace engine
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+void demonstrate_selection() {
+    section_header("Selection vector on the 03 input");
+    std::vector<int> data = {1, -2, 3, -4, 5, -6, 7, -8, 9, -10};
+    auto is_positive = [](int x) { return x > 0; };
+    auto square = [](int x) { return x * x; };
+
+    engine::SelectionVector sel;
+    engine::select(data.data(), data.size(), is_positive, sel);
+    std::cout << "  select(is_positive) -> indices: ";
+    for (std::size_t k = 0; k < sel.count; ++k) std::cout << sel.index[k] << " ";
+    std::cout << "\n  sum_selected(square) = " << engine::sum_selected(data.data(), sel, square) << "  (03 demo: 165)\n";
+
+    engine::refine(data.data(), [](int x) { return x > 4; }, sel);
+    std::cout << "  refine(x > 4) -> indices: ";
+    for (std::size_t k = 0; k < sel.count; ++k) std::cout << sel.index[k] << " ";
+    std::cout << "\n  No value was copied: both filters only rewrote the index list\n";
+}
+
+void benchmark_selectivity(std::size_t n) {
+    section_header("BENCHMARK: filter -> square -> sum across selectivities");
+    std::vector<int> data(n);
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    for (int& x : data) x = dist(rng);
+    std::cout << "  Elements: " << n << ", batch: " << engine::kBatch << " values\n";
+    std::cout << "  ms per full pass (best of 5); 'check' compares every result with the copy_if pipeline\n\n";
+
+    auto square = [](int x) -> long long { return static_cast<long long>(x) * x; };
+
+    std::cout << std::setw(12) << "selectivity" << std::setw(14) << "copy_if+xform" << std::setw(12) << "fused loop"
+              << std::setw(12) << "selvec" << std::setw(12) << "bitmap+ctz" << std::setw(13) << "bitmap dense"
+              << std::setw(11) << "adaptive" << "  check\n";
+
+    for (double selectivity : {0.01, 0.10, 0.50, 0.90, 0.99}) {
+        // x > threshold keeps ~selectivity of a uniform [-1000, 1000] input
+        const int threshold = static_cast<int>(1000 - selectivity * 2001);
+        auto pred = [threshold](int x) { return x > threshold; };
+
+        long long expected = 0, result = 0;
+        bool ok = true;
+        auto check = [&] { ok = ok && result == expected; };
+
+        double copy_ms = time_ms([&] {
+            std::vector<int> survivors;
+            std::copy_if(data.begin(), data.end(), std::back_inserter(survivors), pred);
+            std::vector<long long> squared;
+            std::transform(survivors.begin(), survivors.end(), std::back_inserter(squared), square);
+            expected = std::accumulate(squared.begin(), squared.end(), 0LL);
+        });
+        double fused_ms = time_ms([&] {
+            result = std::accumulate(data.begin(), data.end(), 0LL,
+                [&](long long sum, int x) { return pred(x) ? sum + square(x) : sum; });
+        });
+        check();
+        double selvec_ms = time_ms([&] { result = engine::run_pipeline(data, pred, square, engine::Mode::SelectionVector); });
+        check();
+        double sparse_ms = time_ms([&] { result = engine::run_pipeline(data, pred, square, engine::Mode::BitmapSparse); });
+        check();
+        double dense_ms = time_ms([&] { result = engine::run_pipeline(data, pred, square, engine::Mode::BitmapDense); });
+        check();
+        double adaptive_ms = time_ms([&] { result = engine::run_pipeline(data, pred, square, engine::Mode::Adaptive); });
+        check();
+
+        std::cout << std::fixed << std::setprecision(0) << std::setw(11) << selectivity * 100 << "%"
+                  << std::setprecision(2) << std::setw(14) << copy_ms << std::setw(12) << fused_ms
+                  << std::setw(12) << selvec_ms << std::setw(12) << sparse_ms << std::setw(13) << dense_ms
+                  << std::setw(11) << adaptive_ms << "  " << (ok ? "OK" : "MISMATCH") << '\n';
+    }
+#if !defined(__AVX2__)
+    std::cout << "  (bitmap dense needs 64-bit lane multiplies; configure with -DLAMBDA_NATIVE_ARCH=ON to vectorize it)\n";
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = 1u << 23;
+    if (argc > 1) n = std::strtoull(argv[1], nullptr, 10);
+
+    std::cout << "Selection-Vector Execution vs Materialized Filter Output\n";
+    std::cout << "========================================================\n";
+
+    demonstrate_selection();
+    benchmark_selectivity(n);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ Filters emit indices/bits per batch; no survivor vector is ever allocated\n";
+    std::cout << "  ✅ Branch-free selection keeps the filter cost flat across selectivities\n";
+    std::cout << "  ✅ Sparse survivors: walk indices or set bits; dense survivors: compute all lanes and mask\n";
+    std::cout << "  ✅ Adaptive mode picks per batch, so one plan handles every selectivity\n";
+    return 0;
+}
@@ -0,0 +1,378 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 09_parallel_scan.cpp
+ *
+ * PURPOSE: A scan (prefix) stage for the pipeline. Filter/map/reduce gives
+ * one number; scan gives the running totals of the transformed values.
+ *
+ *   data     =  1  -2   3  -4   5
+ *   square   =  1   4   9  16  25
+ *   inclusive=  1   5  14  30  55      out[i] = op(in[0], ..., in[i])
+ *   exclusive=  0   1   5  14  30      out[i] = op(init, in[0], ..., in[i-1])
+ *
+ * Any associative lambda works (std::inclusive_scan semantics: the order of
+ * operands is preserved, the op does NOT have to be commutative). Three levels:
+ *
+ *   1. scan::inclusive_scan / exclusive_scan   sequential, any lambda
+ *   2. scan::lanewise(lambda)                  a generic lambda that also
+ *      works on simd::i64x4 runs as an in-register scan: 4 lanes, 2 shift+op
+ *      steps, then the carry from the previous block is broadcast and applied
+ *   3. scan::parallel_inclusive_scan           reduce-then-scan over threads:
+ *        pass 1: every thread reduces its chunk     (reads input)
+ *        serial: exclusive scan of the chunk totals (T values)
+ *        pass 2: every thread scans its chunk, seeded with its offset
+ *
+ * Build: g++ -std=c++17 -O2 09_parallel_scan.cpp -o 09_scan_cpp17 -pthread
+ *        g++ -std=c++17 -O2 -march=native 09_parallel_scan.cpp -o 09_scan_avx2 -pthread
+ * Run:   ./09_scan_cpp17 [max_elements] [threads]
+ */
+
+namespace simd {
+
+// Four int64 lanes: wide enough for running totals of squared int32 values
+#if defined(__AVX2__)
+struct i64x4 {
+    static constexpr std::size_t width = 4;
+    __m256i v;
+
+    i64x4() : v(_mm256_setzero_si256()) {}
+    i64x4(long long x) : v(_mm256_set1_epi64x(x)) {}   // Broadcast
+    explicit i64x4(__m256i raw) : v(raw) {}
+
+    static i64x4 load(const long long* p) { return i64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))); }
+    void store(long long* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+    // [a b c d] -> [a a b c] and [a a a b]; the low lanes are fixed by keep_low()
+    i64x4 shift1() const { return i64x4(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0))); }
+    i64x4 shift2() const { return i64x4(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0))); }
+    i64x4 broadcast_last() const { return i64x4(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3))); }
+    long long last() const { return _mm256_extract_epi64(v, 3); }
+
+    // Lanes [0, k) from a, the rest from b
+    template <int K>
+    static i64x4 keep_low(i64x4 a, i64x4 b) { return i64x4(_mm256_blend_epi32(b.v, a.v, (1 << (2 * K)) - 1)); }
+
+    friend i64x4 operator+(i64x4 a, i64x4 b) { return i64x4(_mm256_add_epi64(a.v, b.v)); }
+    friend i64x4 operator-(i64x4 a, i64x4 b) { return i64x4(_mm256_sub_epi64(a.v, b.v)); }
+    friend i64x4 operator^(i64x4 a, i64x4 b) { return i64x4(_mm256_xor_si256(a.v, b.v)); }
+    friend i64x4 operator|(i64x4 a, i64x4 b) { return i64x4(_mm256_or_si256(a.v, b.v)); }
+    friend i64x4 operator&(i64x4 a, i64x4 b) { return i64x4(_mm256_and_si256(a.v, b.v)); }
+    friend i64x4 max(i64x4 a, i64x4 b) { return i64x4(_mm256_blendv_epi8(b.v, a.v, _mm256_cmpgt_epi64(a.v, b.v))); }
+    friend i64x4 min(i64x4 a, i64x4 b) { return i64x4(_mm256_blendv_epi8(a.v, b.v, _mm256_cmpgt_epi64(a.v, b.v))); }
+};
+#else
+struct i64x4 {
+    static constexpr std::size_t width = 4;
+    long long v[4];
+
+    i64x4() : v{} {}
+    i64x4(long long x) : v{x, x, x, x} {}
+
+    static i64x4 load(const long long* p) { i64x4 r; for (std::size_t i = 0; i < width; ++i) r.v[i] = p[i]; return r; }
+    void store(long long* p) const { for (std::size_t i = 0; i < width; ++i) p[i] = v[i]; }
+
+    // No lane shuffles: without AVX2 the in-register scan loses to the scalar
+    // loop, so only the reduction uses this type (see scan::inclusive_block)
+
+    template <typename F>
+    static i64x4 zip(const i64x4& a, const i64x4& b, F f) {
+        i64x4 r;
+        for (std::size_t i = 0; i < width; ++i) r.v[i] = f(a.v[i], b.v[i]);
+        return r;
+    }
+
+    friend i64x4 operator+(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x + y; }); }
+    friend i64x4 operator-(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x - y; }); }
+    friend i64x4 operator^(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x ^ y; }); }
+    friend i64x4 operator|(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x | y; }); }
+    friend i64x4 operator&(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x & y; }); }
+    friend i64x4 max(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x > y ? x : y; }); }
+    friend i64x4 min(const i64x4& a, const i64x4& b) { return zip(a, b, [](long long x, long long y) { return x < y ? x : y; }); }
+};
+#endif
+
+}  // namespace simd
+
+namespace scan {
+
+// ===== Lane-wise operators =====
+// Marks a generic lambda as safe to call on simd::i64x4 (element-wise ops only).
+// The parallel reduce pass combines lanes out of order, so a lanewise op must
+// also be commutative - true for +, ^, |, &, min, max.
+template <typename Op>
+struct lanewise_op {
+    Op op;
+    template <typename T>
+    T operator()(const T& a, const T& b) const { return op(a, b); }
+};
+
+template <typename Op>
+lanewise_op<Op> lanewise(Op op) { return lanewise_op<Op>{op}; }
+
+template <typename Op>
+struct is_lanewise : std::false_type {};
+template <typename Op>
+struct is_lanewise<lanewise_op<Op>> : std::true_type {};
+
+// ===== Sequential scans =====
+// Each returns the last value written so callers can chain blocks.
+template <typename Op>
+long long inclusive_block(const long long* in, long long* out, std::size_t n, long long carry, bool has_carry,
+                          Op op, std::false_type /*scalar*/) {
+    std::size_t i = 0;
+    if (!has_carry && n > 0) carry = out[i] = in[i], ++i;
+    for (; i < n; ++i) out[i] = carry = op(carry, in[i]);
+    return carry;
+}
+
+template <typename Op>
+long long inclusive_block(const long long* in, long long* out, std::size_t n, long long carry, bool has_carry,
+                          Op op, std::true_type /*lanewise*/) {
+#if !defined(__AVX2__)
+    // SSE2 has two int64 lanes and no cross-lane permute: the scalar loop wins
+    return inclusive_block(in, out, n, carry, has_carry, op, std::false_type{});
+#else
+    using simd::i64x4;
+    std::size_t i = 0;
+    if (!has_carry) {
+        if (n == 0) return carry;
+        carry = out[0] = in[0];
+        i = 1;
+    }
+    i64x4 carry_v(carry);
+    for (; i + i64x4::width <= n; i += i64x4::width) {
+        i64x4 x = i64x4::load(in + i);
+        x = i64x4::keep_low<1>(x, op(x.shift1(), x));   // [a, a+b, b+c, c+d]
+        x = i64x4::keep_low<2>(x, op(x.shift2(), x));   // [a, a+b, a+b+c, a+b+c+d]
+        x = op(carry_v, x);
+        x.store(out + i);
+        carry_v = x.broadcast_last();
+    }
+    carry = carry_v.last();
+    for (; i < n; ++i) out[i] = carry = op(carry, in[i]);
+    return carry;
+#endif
+}
+
+// out may equal in (in-place), as with std::inclusive_scan
+template <typename Op>
+void inclusive_scan(const long long* in, long long* out, std::size_t n, Op op) {
+    inclusive_block(in, out, n, 0, false, op, is_lanewise<Op>{});
+}
+
+template <typename Op>
+void inclusive_scan(const long long* in, long long* out, std::size_t n, long long init, Op op) {
+    inclusive_block(in, out, n, init, true, op, is_lanewise<Op>{});
+}
+
+template <typename Op>
+void exclusive_scan(const long long* in, long long* out, std::size_t n, long long init, Op op) {
+    long long carry = init;
+    for (std::size_t i = 0; i < n; ++i) {
+        const long long x = in[i];   // Read before write: safe in-place
+        out[i] = carry;
+        carry = op(carry, x);
+    }
+}
+
+// ===== Reduction (pass 1) =====
+template <typename Op>
+long long reduce_block(const long long* in, std::size_t n, Op op, std::false_type) {
+    long long acc = in[0];
+    for (std::size_t i = 1; i < n; ++i) acc = op(acc, in[i]);
+    return acc;
+}
+
+template <typename Op>
+long long reduce_block(const long long* in, std::size_t n, Op op, std::true_type) {
+    using simd::i64x4;
+    if (n < 2 * i64x4::width) return reduce_block(in, n, op, std::false_type{});
+    i64x4 acc = i64x4::load(in);
+    std::size_t i = i64x4::width;
+    for (; i + i64x4::width <= n; i += i64x4::width) acc = op(acc, i64x4::load(in + i));
+    long long lanes[i64x4::width];
+    acc.store(lanes);
+    long long total = lanes[0];
+    for (std::size_t k = 1; k < i64x4::width; ++k) total = op(total, lanes[k]);
+    for (; i < n; ++i) total = op(total, in[i]);
+    return total;
+}
+
+// ===== Parallel reduce-then-scan =====
+template <typename Op>
+void parallel_inclusive_scan(const long long* in, long long* out, std::size_t n, Op op, unsigned threads) {
+    if (threads <= 1 || n < (1u << 16)) {
+        inclusive_scan(in, out, n, op);
+        return;
+    }
+    // Chunk boundaries on 4-element multiples keep every vector load aligned to the chunk
+    const std::size_t chunk = ((n + threads - 1) / threads + 3) & ~std::size_t{3};
+    const unsigned chunks = static_cast<unsigned>((n + chunk - 1) / chunk);
+    std::vector<long long> totals(chunks);
+
+    auto run = [&](auto&& body) {
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < chunks; ++t) pool.emplace_back(body, t);
+        body(0u);
+        for (auto& th : pool) th.join();
+    };
+
+    // Pass 1: chunk totals (the last chunk's total is never needed)
+    run([&](unsigned t) {
+        if (t + 1 == chunks) return;
+        totals[t] = reduce_block(in + t * chunk, chunk, op, is_lanewise<Op>{});
+    });
+
+    // Serial: offset of chunk t = op(total[0], ..., total[t-1])
+    for (unsigned t = 1; t + 1 < chunks; ++t) totals[t] = op(totals[t - 1], totals[t]);
+
+    // Pass 2: scan every chunk seeded with its offset
+    run([&](unsigned t) {
+        const std::size_t begin = t * chunk;
+        const std::size_t len = std::min(chunk, n - begin);
+        inclusive_block(in + begin, out + begin, len, t == 0 ? 0 : totals[t - 1], t != 0, op, is_lanewise<Op>{});
+    });
+}
+
+}  // namespace scan
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+void print_values(const std::string& label, const std::vector<long long>& values) {
+    std::cout << "  " << std::left << std::setw(28) << label << std::right;
+    for (long long v : values) std::cout << std::setw(5) << v;
+    std::cout << '\n';
+}
+
+void demonstrate_scan() {
+    section_header("Running totals of the 03 pipeline's squares");
+    std::vector<int> data = {1, -2, 3, -4, 5, -6, 7, -8, 9, -10};
+    std::vector<long long> squared(data.size()), out(data.size());
+    std::transform(data.begin(), data.end(), squared.begin(), [](int x) { return static_cast<long long>(x) * x; });
+
+    auto plus = scan::lanewise([](auto a, auto b) { return a + b; });
+    auto running_max = scan::lanewise([](auto a, auto b) { using std::max; return max(a, b); });
+    auto mod_add = [](long long a, long long b) { return (a + b) % 97; };   // Scalar-only lambda
+
+    print_values("square(data)", squared);
+    scan::inclusive_scan(squared.data(), out.data(), out.size(), plus);
+    print_values("inclusive_scan(+)", out);
+    scan::exclusive_scan(squared.data(), out.data(), out.size(), 0, plus);
+    print_values("exclusive_scan(+, 0)", out);
+    std::vector<long long> signed_data(data.begin(), data.end());
+    scan::inclusive_scan(signed_data.data(), out.data(), out.size(), running_max);
+    print_values("inclusive_scan(max) of data", out);
+    scan::inclusive_scan(squared.data(), out.data(), out.size(), mod_add);
+    print_values("inclusive_scan((a+b)%97)", out);
+
+#if __cplusplus >= 201703L
+    std::vector<long long> reference(data.size());
+    std::inclusive_scan(squared.begin(), squared.end(), reference.begin(), [](long long a, long long b) { return (a + b) % 97; });
+    std::cout << "  matches std::inclusive_scan: " << (reference == out ? "yes" : "NO") << '\n';
+#endif
+}
+
+void benchmark_scan(std::size_t max_n, unsigned threads) {
+    section_header("BENCHMARK: inclusive running total (+) of int64 values");
+    std::cout << "  Threads for the parallel scan: " << threads << "  (hardware_concurrency = "
+              << std::thread::hardware_concurrency() << ")\n";
+    if (threads == 1) std::cout << "  (one thread: parallel_inclusive_scan falls back to the sequential scan)\n";
+    std::cout << "  ms per scan (best of 3); speedup vs std::partial_sum\n\n";
+    std::cout << std::setw(14) << "elements" << std::setw(13) << "partial_sum";
+#if __cplusplus >= 201703L
+    std::cout << std::setw(15) << "std::incl_scan";
+#endif
+    std::cout << std::setw(13) << "scalar" << std::setw(13) << "simd" << std::setw(16) << "parallel+simd" << "  check\n";
+
+    auto plus = scan::lanewise([](auto a, auto b) { return a + b; });
+    auto plus_scalar = [](long long a, long long b) { return a + b; };
+
+    std::vector<std::size_t> sizes;
+    for (std::size_t n = 1u << 20; n <= max_n; n *= 8) sizes.push_back(n);
+    if (sizes.empty() || sizes.back() != max_n) sizes.push_back(max_n);
+
+    for (std::size_t n : sizes) {
+        std::vector<long long> in(n), out(n), expected(n);
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<int> dist(-1000, 1000);
+        for (auto& x : in) { const int v = dist(rng); x = static_cast<long long>(v) * v; }
+
+        auto speed = [](double base, double ms) { return base / ms; };
+        bool ok = true;
+        const int reps = 3;
+
+        double partial_ms = time_ms([&] { std::partial_sum(in.begin(), in.end(), expected.begin()); }, reps);
+#if __cplusplus >= 201703L
+        double std_ms = time_ms([&] { std::inclusive_scan(in.begin(), in.end(), out.begin()); }, reps);
+        ok = ok && out == expected;
+#endif
+        double scalar_ms = time_ms([&] { scan::inclusive_scan(in.data(), out.data(), n, plus_scalar); }, reps);
+        ok = ok && out == expected;
+        double simd_ms = time_ms([&] { scan::inclusive_scan(in.data(), out.data(), n, plus); }, reps);
+        ok = ok && out == expected;
+        double par_ms = time_ms([&] { scan::parallel_inclusive_scan(in.data(), out.data(), n, plus, threads); }, reps);
+        ok = ok && out == expected;
+
+        std::cout << std::setw(14) << n << std::fixed << std::setprecision(2) << std::setw(13) << partial_ms;
+#if __cplusplus >= 201703L
+        std::cout << std::setw(15) << std_ms;
+#endif
+        std::cout << std::setw(13) << scalar_ms << std::setw(13) << simd_ms << std::setw(16) << par_ms
+                  << "  " << (ok ? "OK" : "MISMATCH") << "  simd " << std::setprecision(1)
+                  << speed(partial_ms, simd_ms) << "x, parallel " << speed(partial_ms, par_ms) << "x\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_n = std::size_t{1} << 27;   // 128M int64 = 1 GB per buffer, three buffers
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1) max_n = std::strtoull(argv[1], nullptr, 10);
+    if (argc > 2) threads = static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10));
+
+    std::cout << "Parallel Prefix Scan with Lambda Operators\n";
+    std::cout << "==========================================\n";
+
+    demonstrate_scan();
+    benchmark_scan(max_n, threads);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ inclusive/exclusive scan accept any associative lambda, in-place allowed\n";
+    std::cout << "  ✅ scan::lanewise(generic lambda) reuses the same lambda on 4 int64 lanes\n";
+    std::cout << "  ✅ reduce-then-scan reads the input twice but lets every thread work independently\n";
+    std::cout << "  ⚠️ Large scans are memory-bound: extra cores help only until DRAM bandwidth is saturated\n";
+#if !defined(__AVX2__)
+    std::cout << "  ⚠️ Built without AVX2: the simd column uses the scalar scan (configure with -DLAMBDA_NATIVE_ARCH=ON)\n";
+#endif
+    std::cout << "  ⚠️ 1B elements need 24 GB (input, output, reference); pass it explicitly: ./09_parallel_scan_cpp17 1073741824\n";
+    return 0;
+}
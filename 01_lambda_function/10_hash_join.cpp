@@ -0,0 +1,349 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * 10_hash_join.cpp
+ *
+ * PURPOSE: A join stage for two datasets shaped like the pipeline's `data`
+ * (std::vector<int>). Key extraction and output projection are lambdas:
+ *
+ *   join::hash_join(build, probe,
+ *                   [](int row) { return row >> 4; },            // build key
+ *                   [](int row) { return row >> 4; },            // probe key
+ *                   [](int b, int p) { return (b & 15) * (p & 15); },  // projection
+ *                   sink);                                       // consumes outputs
+ *
+ * THE TABLE (join::JoinTable): open addressing over 64-byte buckets, one cache
+ * line each: 8 key slots + 7 row slots + a count. A probe hashes once, loads
+ * one line and compares all keys of the bucket at once (AVX2 cmpeq + movemask,
+ * two SSE2 halves, or a plain loop). Rows are copied into the table, so a hit
+ * needs no second random access. Full buckets overflow into the next one.
+ *
+ * PROBE STRATEGIES:
+ *   tuple-at-a-time   hash, load, compare - every miss in cache stalls the loop
+ *   batched+prefetch  hash 32 keys, prefetch their 32 buckets, then compare:
+ *                     the cache misses overlap instead of queueing
+ *   radix-partitioned both sides are scattered by the top hash bits into
+ *                     partitions whose tables fit in L2; needed once the build
+ *                     side outgrows the last-level cache
+ *
+ * Build: g++ -std=c++14 -O2 10_hash_join.cpp -o 10_hash_join_cpp14
+ * Run:   ./10_hash_join_cpp14 [probe_rows]
+ */
+
+namespace join {
+
+inline std::uint64_t hash_key(std::uint32_t key) { return key * 0x9E3779B97F4A7C15ull; }
+
+// Up to 8 set bits: which of the bucket's keys equal `key`
+inline unsigned match_mask(const std::uint32_t* keys, std::uint32_t key) {
+#if defined(__AVX2__)
+    const __m256i eq = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(keys)), _mm256_set1_epi32(static_cast<int>(key)));
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+#elif defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi32(static_cast<int>(key));
+    const __m128i lo = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(keys)), needle);
+    const __m128i hi = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + 4)), needle);
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(lo)) | (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4));
+#else
+    unsigned mask = 0;
+    for (unsigned j = 0; j < 8; ++j) mask |= static_cast<unsigned>(keys[j] == key) << j;
+    return mask;
+#endif
+}
+
+template <typename Row>
+class JoinTable {
+public:
+    static constexpr unsigned kSlots = 7;
+
+    // skip_bits: hash bits already consumed by radix partitioning
+    template <typename KeyFn>
+    JoinTable(const Row* rows, std::size_t n, KeyFn key, unsigned skip_bits = 0) : skip_bits_(skip_bits) {
+        bucket_bits_ = 1;
+        while ((std::size_t{1} << bucket_bits_) * 4 < n * 2) ++bucket_bits_;   // <= 2 rows per bucket: <= ~29% full (2 of 7 slots)
+        mask_ = (std::size_t{1} << bucket_bits_) - 1;
+        storage_.reset(new unsigned char[(mask_ + 1) * sizeof(Bucket) + 64]());
+        void* p = storage_.get();
+        std::size_t space = (mask_ + 1) * sizeof(Bucket) + 64;
+        buckets_ = static_cast<Bucket*>(std::align(64, (mask_ + 1) * sizeof(Bucket), p, space));
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint32_t k = key(rows[i]);
+            std::size_t b = bucket_of(k);
+            while (buckets_[b].count == kSlots) b = (b + 1) & mask_;
+            Bucket& bucket = buckets_[b];
+            bucket.keys[bucket.count] = k;
+            bucket.rows[bucket.count] = rows[i];
+            ++bucket.count;
+        }
+    }
+
+    std::size_t bytes() const { return (mask_ + 1) * sizeof(Bucket); }
+
+    std::size_t bucket_of(std::uint32_t key) const {
+        return static_cast<std::size_t>((hash_key(key) << skip_bits_) >> (64 - bucket_bits_));
+    }
+
+    template <typename ProbeRow, typename Project, typename Sink>
+    void probe_bucket(std::size_t b, std::uint32_t key, const ProbeRow& row, Project& project, Sink& sink) const {
+        while (true) {
+            const Bucket& bucket = buckets_[b];
+            unsigned mask = match_mask(bucket.keys, key) & ((1u << bucket.count) - 1);
+            while (mask) {
+                const int j = __builtin_ctz(mask);
+                sink(project(bucket.rows[j], row));
+                mask &= mask - 1;
+            }
+            if (bucket.count < kSlots) return;   // Overflow chains only continue past full buckets
+            b = (b + 1) & mask_;
+        }
+    }
+
+    template <typename ProbeRow, typename KeyFn, typename Project, typename Sink>
+    void probe(const ProbeRow* rows, std::size_t n, KeyFn key, Project project, Sink& sink) const {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint32_t k = key(rows[i]);
+            probe_bucket(bucket_of(k), k, rows[i], project, sink);
+        }
+    }
+
+    // Hash a batch, prefetch every bucket, then compare: misses overlap
+    template <typename ProbeRow, typename KeyFn, typename Project, typename Sink>
+    void probe_batched(const ProbeRow* rows, std::size_t n, KeyFn key, Project project, Sink& sink) const {
+        constexpr std::size_t kBatch = 32;
+        std::uint32_t keys[kBatch];
+        std::size_t buckets[kBatch];
+        for (std::size_t start = 0; start < n; start += kBatch) {
+            const std::size_t m = std::min(kBatch, n - start);
+            for (std::size_t j = 0; j < m; ++j) {
+                keys[j] = key(rows[start + j]);
+                buckets[j] = bucket_of(keys[j]);
+                __builtin_prefetch(&buckets_[buckets[j]]);
+            }
+            for (std::size_t j = 0; j < m; ++j) probe_bucket(buckets[j], keys[j], rows[start + j], project, sink);
+        }
+    }
+
+private:
+    struct Bucket {
+        alignas(32) std::uint32_t keys[8];   // keys[7] is never filled: padding for the 8-lane compare
+        Row rows[kSlots];
+        std::uint32_t count;
+    };
+
+    std::unique_ptr<unsigned char[]> storage_;
+    Bucket* buckets_ = nullptr;
+    std::size_t mask_ = 0;
+    unsigned bucket_bits_ = 1;
+    unsigned skip_bits_ = 0;
+};
+
+// ===== Radix partitioning =====
+// Rows grouped by the top `bits` of their key hash; offsets has 2^bits + 1 entries
+template <typename Row>
+struct Partitions {
+    std::vector<Row> rows;
+    std::vector<std::size_t> offsets;
+};
+
+template <typename Row, typename KeyFn>
+Partitions<Row> radix_partition(const std::vector<Row>& input, KeyFn key, unsigned bits) {
+    const std::size_t fanout = std::size_t{1} << bits;
+    auto partition_of = [&](const Row& row) {
+        return bits == 0 ? 0 : static_cast<std::size_t>(hash_key(key(row)) >> (64 - bits));
+    };
+
+    Partitions<Row> out;
+    out.offsets.assign(fanout + 1, 0);
+    for (const Row& row : input) ++out.offsets[partition_of(row) + 1];
+    std::partial_sum(out.offsets.begin(), out.offsets.end(), out.offsets.begin());
+
+    std::vector<std::size_t> cursor(out.offsets.begin(), out.offsets.end() - 1);
+    out.rows.resize(input.size());
+    for (const Row& row : input) out.rows[cursor[partition_of(row)]++] = row;
+    return out;
+}
+
+constexpr std::size_t kPartitionRows = 1 << 13;   // ~256 KB table per partition: stays in L2
+
+inline unsigned radix_bits_for(std::size_t build_rows) {
+    unsigned bits = 0;
+    while ((build_rows >> bits) > kPartitionRows) ++bits;
+    return bits;
+}
+
+// ===== Join entry points =====
+template <typename B, typename P, typename BK, typename PK, typename Project, typename Sink>
+void hash_join(const std::vector<B>& build, const std::vector<P>& probe, BK build_key, PK probe_key,
+               Project project, Sink& sink) {
+    JoinTable<B> table(build.data(), build.size(), build_key);
+    table.probe_batched(probe.data(), probe.size(), probe_key, project, sink);
+}
+
+template <typename B, typename P, typename BK, typename PK, typename Project, typename Sink>
+void radix_hash_join(const std::vector<B>& build, const std::vector<P>& probe, BK build_key, PK probe_key,
+                     Project project, Sink& sink) {
+    const unsigned bits = radix_bits_for(build.size());
+    if (bits == 0) return hash_join(build, probe, build_key, probe_key, project, sink);   // Already fits in L2
+    const Partitions<B> build_parts = radix_partition(build, build_key, bits);
+    const Partitions<P> probe_parts = radix_partition(probe, probe_key, bits);
+    for (std::size_t p = 0; p + 1 < build_parts.offsets.size(); ++p) {
+        const std::size_t b_begin = build_parts.offsets[p], b_end = build_parts.offsets[p + 1];
+        const std::size_t p_begin = probe_parts.offsets[p], p_end = probe_parts.offsets[p + 1];
+        if (b_begin == b_end || p_begin == p_end) continue;
+        JoinTable<B> table(build_parts.rows.data() + b_begin, b_end - b_begin, build_key, bits);
+        table.probe_batched(probe_parts.rows.data() + p_begin, p_end - p_begin, probe_key, project, sink);
+    }
+}
+
+// Last-level cache size from glibc, 8 MB if unknown
+inline std::size_t llc_bytes() {
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (l3 > 0) return static_cast<std::size_t>(l3);
+#endif
+    return std::size_t{8} << 20;
+}
+
+}  // namespace join
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 3) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+struct SumSink {
+    long long sum = 0;
+    std::size_t count = 0;
+    void operator()(long long value) { sum += value; ++count; }
+};
+
+void demonstrate_join() {
+    section_header("Joining two small streams");
+    // Rows pack a key in the high bits and a 4-bit payload in the low bits
+    std::vector<int> customers = {(1 << 4) | 3, (2 << 4) | 5, (3 << 4) | 7};
+    std::vector<int> orders = {(2 << 4) | 1, (9 << 4) | 2, (1 << 4) | 4, (2 << 4) | 6};
+    auto key = [](int row) { return static_cast<std::uint32_t>(row >> 4); };
+    auto project = [](int c, int o) -> long long {
+        std::cout << "    key " << (c >> 4) << ": customer payload " << (c & 15) << " x order payload " << (o & 15) << '\n';
+        return static_cast<long long>(c & 15) * (o & 15);
+    };
+    SumSink sink;
+    join::hash_join(customers, orders, key, key, project, sink);
+    std::cout << "  matches: " << sink.count << " (order with key 9 has no customer), sum = " << sink.sum << '\n';
+}
+
+void benchmark_join(std::size_t probe_rows) {
+    section_header("BENCHMARK: build:probe ratios");
+    const std::size_t llc = join::llc_bytes();
+    std::cout << "  Probe side: " << probe_rows << " rows (90% hit), LLC: " << llc / 1024 << " KB\n";
+    std::cout << "  ms per join (best of 3), speedup vs std::unordered_multimap\n\n";
+    std::cout << std::setw(9) << "ratio" << std::setw(11) << "build" << std::setw(12) << "table"
+              << std::setw(15) << "unordered_mm" << std::setw(15) << "tuple-at-time" << std::setw(15) << "batch+prefetch"
+              << std::setw(12) << "radix" << "  check\n";
+
+    auto key = [](int row) { return static_cast<std::uint32_t>(row >> 4); };
+    auto project = [](int b, int p) { return static_cast<long long>(b & 15) * (p & 15); };
+
+    for (std::size_t ratio : {std::size_t{1}, std::size_t{100}, std::size_t{10000}}) {
+        const std::size_t build_rows = std::max<std::size_t>(1, probe_rows / ratio);
+        std::mt19937 rng(9);
+
+        // Build: unique keys in random order; probe: 90% existing keys, 10% misses
+        std::vector<int> build(build_rows);
+        for (std::size_t i = 0; i < build_rows; ++i) build[i] = static_cast<int>((i << 4) | (rng() & 15));
+        std::shuffle(build.begin(), build.end(), rng);
+        std::vector<int> probe(probe_rows);
+        std::uniform_int_distribution<std::size_t> pick(0, build_rows - 1);
+        for (int& row : probe) {
+            const std::size_t k = rng() % 10 == 0 ? build_rows + pick(rng) : pick(rng);
+            row = static_cast<int>((k << 4) | (rng() & 15));
+        }
+
+        SumSink expected, result;
+        bool ok = true;
+        auto check = [&] { ok = ok && result.sum == expected.sum && result.count == expected.count; };
+
+        double baseline_ms = time_ms([&] {
+            expected = SumSink{};
+            std::unordered_multimap<std::uint32_t, int> table;
+            table.reserve(build.size());
+            for (int row : build) table.emplace(key(row), row);
+            for (int row : probe) {
+                auto range = table.equal_range(key(row));
+                for (auto it = range.first; it != range.second; ++it) expected(project(it->second, row));
+            }
+        });
+        std::size_t table_bytes = 0;
+        double tuple_ms = time_ms([&] {
+            result = SumSink{};
+            join::JoinTable<int> table(build.data(), build.size(), key);
+            table.probe(probe.data(), probe.size(), key, project, result);
+            table_bytes = table.bytes();
+        });
+        check();
+        double batch_ms = time_ms([&] {
+            result = SumSink{};
+            join::hash_join(build, probe, key, key, project, result);
+        });
+        check();
+        double radix_ms = time_ms([&] {
+            result = SumSink{};
+            join::radix_hash_join(build, probe, key, key, project, result);
+        });
+        check();
+
+        std::cout << std::setw(7) << "1:" << std::left << std::setw(6) << ratio << std::right << std::setw(8) << build_rows
+                  << std::setw(10) << table_bytes / 1024 << "KB" << std::fixed << std::setprecision(2)
+                  << std::setw(15) << baseline_ms << std::setw(15) << tuple_ms << std::setw(15) << batch_ms
+                  << std::setw(12) << radix_ms << "  " << (ok ? "OK" : "MISMATCH")
+                  << "  (" << std::setprecision(1) << baseline_ms / std::min(batch_ms, radix_ms)
+                  << "x, table " << (table_bytes > llc ? "> LLC" : "fits LLC") << ")\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t probe_rows = std::size_t{1} << 23;
+    if (argc > 1) probe_rows = std::strtoull(argv[1], nullptr, 10);
+
+    std::cout << "Hash Join Between Two Lambda-Processed Datasets\n";
+    std::cout << "===============================================\n";
+
+    demonstrate_join();
+    benchmark_join(probe_rows);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ One cache line per bucket: a probe is one hash, one load, one 8-key compare\n";
+    std::cout << "  ✅ Batched probes prefetch 32 buckets ahead so cache misses overlap\n";
+    std::cout << "  ✅ Radix partitioning keeps each partition's table in L2 when the build side outgrows the LLC\n";
+    std::cout << "  ✅ Keys and outputs are lambdas; the join inlines them like any other pipeline stage\n";
+    return 0;
+}
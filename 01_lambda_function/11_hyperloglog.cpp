@@ -0,0 +1,397 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 11_hyperloglog.cpp
+ *
+ * PURPOSE: A distinct-count reducer that sits next to get_stats() from
+ * 03_lambda_evolution_demo.cpp. An exact std::unordered_set needs memory
+ * proportional to the number of distinct values; HyperLogLog needs 16 KB
+ * for any cardinality, with ~0.8% standard error.
+ *
+ *   hash(value)  = 64 bits:  [ 14 bits register index | 50 bits ... ]
+ *   register[i]  = max over all values routed to i of (leading zeros + 1)
+ *   estimate     = alpha * m^2 / sum(2^-register[i])  (linear counting when small)
+ *
+ * REPRESENTATIONS (HLL++ style):
+ *   sparse  a small hash table of (25-bit index, rank) entries: near-exact at
+ *           low cardinality, 4 bytes per distinct hash, sorted on the wire
+ *   dense   16384 one-byte registers, used once the sparse list outgrows them
+ *
+ * MERGING: two sketches merge by taking the per-register max, which is a
+ * byte-wise vector max (one instruction per 32 registers with AVX2). Sketches
+ * from other threads merge directly; sketches from other processes travel
+ * through serialize() / HyperLogLog::deserialize().
+ *
+ * Build: g++ -std=c++14 -O2 11_hyperloglog.cpp -o 11_hyperloglog_cpp14 -pthread
+ * Run:   ./11_hyperloglog_cpp14 [rows]
+ */
+
+namespace hll {
+
+// splitmix64 finalizer: every input bit affects every output bit
+inline std::uint64_t mix(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+class HyperLogLog {
+public:
+    static constexpr unsigned kPrecision = 14;
+    static constexpr std::size_t kRegisters = std::size_t{1} << kPrecision;
+    static constexpr unsigned kSparsePrecision = 25;
+
+    void add_hash(std::uint64_t h) {
+        if (!dense_) {
+            const std::uint32_t idx = static_cast<std::uint32_t>(h >> (64 - kSparsePrecision));
+            add_sparse(idx << 6 | rank(h << kSparsePrecision, 64 - kSparsePrecision));
+            return;
+        }
+        const std::size_t idx = static_cast<std::size_t>(h >> (64 - kPrecision));
+        const std::uint8_t r = static_cast<std::uint8_t>(rank(h << kPrecision, 64 - kPrecision));
+        if (r > registers_[idx]) registers_[idx] = r;
+    }
+
+    // Integers hash by value; floating point by its bit pattern, so 1.2 and
+    // 1.7 stay distinct. Other types: hash them yourself and call add_hash()
+    template <typename T>
+    void add(const T& value, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr) {
+        add_hash(mix(static_cast<std::uint64_t>(value)));
+    }
+
+    template <typename T>
+    void add(const T& value, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr) {
+        const double d = value == 0 ? 0.0 : static_cast<double>(value);   // -0.0 == 0.0
+        std::uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        add_hash(mix(bits));
+    }
+
+    void merge(const HyperLogLog& other) {
+        if (&other == this) return;
+        if (!other.dense_) {
+            for (std::uint32_t e : other.sparse_) {
+                if (e == 0) continue;
+                if (dense_) set_dense_from_sparse(e);
+                else add_sparse(e);
+            }
+            return;
+        }
+        if (!dense_) to_dense();
+        max_registers(registers_.data(), other.registers_.data());
+    }
+
+    double estimate() const {
+        if (!dense_) {
+            // Linear counting at the sparse precision: m' = 2^25 buckets
+            const double m = static_cast<double>(std::size_t{1} << kSparsePrecision);
+            return m * std::log(m / (m - static_cast<double>(sparse_count_)));
+        }
+        const double m = static_cast<double>(kRegisters);
+        double sum = 0;
+        std::size_t zeros = 0;
+        for (std::uint8_t r : registers_) {
+            sum += std::ldexp(1.0, -r);
+            zeros += r == 0;
+        }
+        const double alpha = 0.7213 / (1.0 + 1.079 / m);
+        const double raw = alpha * m * m / sum;
+        if (raw <= 2.5 * m && zeros > 0) return m * std::log(m / static_cast<double>(zeros));
+        return raw;
+    }
+
+    bool is_sparse() const { return !dense_; }
+    std::size_t memory_bytes() const { return dense_ ? registers_.size() : sparse_.size() * sizeof(std::uint32_t); }
+
+    // ===== Cross-process transport =====
+    // Format: 'H' 'L' precision mode(0 sparse / 1 dense), then 16384 registers
+    // or a 4-byte count followed by the sorted sparse entries
+    std::string serialize() const {
+        std::string out = {'H', 'L', static_cast<char>(kPrecision), static_cast<char>(dense_ ? 1 : 0)};
+        if (dense_) {
+            out.append(reinterpret_cast<const char*>(registers_.data()), registers_.size());
+            return out;
+        }
+        std::vector<std::uint32_t> entries;
+        entries.reserve(sparse_count_);
+        for (std::uint32_t e : sparse_) {
+            if (e != 0) entries.push_back(e);
+        }
+        std::sort(entries.begin(), entries.end());
+        const std::uint32_t count = static_cast<std::uint32_t>(entries.size());
+        out.append(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.append(reinterpret_cast<const char*>(entries.data()), count * sizeof(std::uint32_t));
+        return out;
+    }
+
+    static HyperLogLog deserialize(const std::string& bytes) {
+        if (bytes.size() < 4 || bytes[0] != 'H' || bytes[1] != 'L' || bytes[2] != static_cast<char>(kPrecision)) {
+            throw std::invalid_argument("HyperLogLog::deserialize: bad header");
+        }
+        HyperLogLog h;
+        if (bytes[3] == 1) {
+            if (bytes.size() != 4 + kRegisters) throw std::invalid_argument("HyperLogLog::deserialize: bad dense size");
+            h.dense_ = true;
+            h.registers_.assign(bytes.begin() + 4, bytes.end());
+            for (std::uint8_t r : h.registers_) {
+                if (r > 64 - kPrecision + 1) throw std::invalid_argument("HyperLogLog::deserialize: bad register");
+            }
+            return h;
+        }
+        std::uint32_t count = 0;
+        if (bytes.size() < 8) throw std::invalid_argument("HyperLogLog::deserialize: truncated");
+        std::memcpy(&count, bytes.data() + 4, sizeof(count));
+        if (bytes.size() != 8 + std::size_t{count} * sizeof(std::uint32_t)) {
+            throw std::invalid_argument("HyperLogLog::deserialize: bad sparse size");
+        }
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::uint32_t e;
+            std::memcpy(&e, bytes.data() + 8 + i * sizeof(e), sizeof(e));
+            // 25-bit index and a rank in 1..40, as add_hash() produces them
+            const std::uint32_t r = e & 63;
+            if ((e >> 6) >= (1u << kSparsePrecision) || r < 1 || r > 64 - kSparsePrecision + 1) {
+                throw std::invalid_argument("HyperLogLog::deserialize: bad sparse entry");
+            }
+            h.add_sparse(e);
+        }
+        return h;
+    }
+
+private:
+    // Sparse entries: 25-bit index << 6 | rank. 4 bytes each, so beyond
+    // kRegisters / 4 entries the dense registers are smaller
+    static constexpr std::size_t kSparseLimit = kRegisters / 4;
+
+    // Leading zeros of the remaining `bits` bits, plus one (capped when all are zero)
+    static std::uint32_t rank(std::uint64_t shifted, unsigned bits) {
+        return shifted == 0 ? bits + 1 : static_cast<std::uint32_t>(__builtin_clzll(shifted)) + 1;
+    }
+
+    // Open addressing keyed by the 25-bit index, 0 = empty (ranks are >= 1)
+    void add_sparse(std::uint32_t entry) {
+        if (sparse_.empty()) sparse_.assign(64, 0);
+        const std::size_t mask = sparse_.size() - 1;
+        std::size_t slot = static_cast<std::size_t>(entry >> 6) & mask;   // Index bits are hash bits already
+        while (sparse_[slot] != 0) {
+            if ((sparse_[slot] >> 6) == (entry >> 6)) {
+                sparse_[slot] = std::max(sparse_[slot], entry);
+                return;
+            }
+            slot = (slot + 1) & mask;
+        }
+        sparse_[slot] = entry;
+        if (++sparse_count_ > kSparseLimit) {
+            to_dense();
+        } else if (sparse_count_ * 2 > sparse_.size()) {
+            std::vector<std::uint32_t> old(sparse_.size() * 2, 0);
+            old.swap(sparse_);
+            sparse_count_ = 0;
+            for (std::uint32_t e : old) {
+                if (e != 0) add_sparse(e);
+            }
+        }
+    }
+
+    // A 25-bit index keeps 11 extra hash bits; they decide the rank at precision 14
+    void set_dense_from_sparse(std::uint32_t entry) {
+        constexpr unsigned extra = kSparsePrecision - kPrecision;
+        const std::uint32_t idx25 = entry >> 6;
+        const std::uint32_t idx = idx25 >> extra;
+        const std::uint32_t low = idx25 & ((1u << extra) - 1);
+        const std::uint32_t r = low != 0 ? static_cast<std::uint32_t>(__builtin_clz(low)) - (32 - extra) + 1
+                                         : extra + (entry & 63);
+        if (r > registers_[idx]) registers_[idx] = static_cast<std::uint8_t>(r);
+    }
+
+    void to_dense() {
+        registers_.assign(kRegisters, 0);
+        for (std::uint32_t e : sparse_) {
+            if (e != 0) set_dense_from_sparse(e);
+        }
+        std::vector<std::uint32_t>().swap(sparse_);
+        sparse_count_ = 0;
+        dense_ = true;
+    }
+
+    // __restrict: without it -O2 refuses the runtime alias check and stays scalar
+    static void max_registers(std::uint8_t* __restrict dst, const std::uint8_t* __restrict src) {
+#if defined(__AVX2__)
+        for (std::size_t i = 0; i < kRegisters; i += 32) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(a, b));
+        }
+#else
+        for (std::size_t i = 0; i < kRegisters; ++i) dst[i] = std::max(dst[i], src[i]);  // must-vectorize
+#endif
+    }
+
+    bool dense_ = false;
+    std::vector<std::uint8_t> registers_;
+    std::vector<std::uint32_t> sparse_;
+    std::size_t sparse_count_ = 0;
+};
+
+// Pipeline reducer: distinct count of fn(x) over a range
+template <typename It, typename Fn>
+HyperLogLog distinct(It first, It last, Fn fn) {
+    HyperLogLog sketch;
+    for (; first != last; ++first) sketch.add(fn(*first));
+    return sketch;
+}
+
+}  // namespace hll
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 3) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+void demonstrate_reducer() {
+    section_header("Distinct count next to get_stats");
+    std::vector<int> data = {1, -2, 3, -4, 5, -6, 7, -8, 9, -10};
+    auto square = [](int x) { return x * x; };
+    auto abs_value = [](int x) { return x > 0 ? x : -x; };
+
+    auto sketch = hll::distinct(data.begin(), data.end(), square);
+    std::cout << "  distinct(square):     ~" << std::llround(sketch.estimate()) << " (sparse: " << std::boolalpha
+              << sketch.is_sparse() << ", " << sketch.memory_bytes() << " bytes)\n";
+    std::vector<int> mirrored = data;
+    for (int x : data) mirrored.push_back(-x);
+    std::cout << "  distinct(abs_value) of data + (-data): ~"
+              << std::llround(hll::distinct(mirrored.begin(), mirrored.end(), abs_value).estimate()) << " (exact: 10)\n";
+
+    // Across processes: bytes out, bytes in, merge
+    const std::string wire = sketch.serialize();
+    auto remote = hll::HyperLogLog::deserialize(wire);
+    remote.merge(hll::distinct(mirrored.begin(), mirrored.end(), abs_value));
+    std::cout << "  serialize(): " << wire.size() << " bytes; after merge with the abs sketch: ~"
+              << std::llround(remote.estimate()) << " (exact: 17)\n";
+}
+
+void benchmark_cardinalities(std::size_t rows) {
+    section_header("BENCHMARK: update throughput and error vs std::unordered_set");
+    std::cout << "  Rows per run: " << rows << " (values drawn from `distinct` possible values, then squared)\n\n";
+    std::cout << std::setw(10) << "distinct" << std::setw(14) << "set ms" << std::setw(12) << "set MB"
+              << std::setw(12) << "hll ms" << std::setw(11) << "hll KB" << std::setw(10) << "mode"
+              << std::setw(12) << "estimate" << std::setw(9) << "error" << std::setw(10) << "speedup\n";
+
+    auto square = [](long long x) { return x * x; };
+
+    for (std::size_t distinct : {std::size_t{1000}, std::size_t{100000}, std::size_t{1000000}, std::size_t{10000000}}) {
+        std::vector<long long> values(rows);
+        std::mt19937_64 rng(17);
+        std::uniform_int_distribution<long long> dist(1, static_cast<long long>(distinct));
+        for (auto& v : values) v = dist(rng);
+
+        std::size_t exact = 0, buckets = 0;
+        double set_ms = time_ms([&] {
+            std::unordered_set<long long> set;
+            for (long long v : values) set.insert(square(v));
+            exact = set.size();
+            buckets = set.bucket_count();
+        }, 1);
+        // Node (value + next + cached hash) plus one bucket pointer
+        const double set_mb = (exact * 24.0 + buckets * 8.0) / (1024.0 * 1024.0);
+
+        hll::HyperLogLog sketch;
+        double hll_ms = time_ms([&] { sketch = hll::distinct(values.begin(), values.end(), square); });
+        const double estimate = sketch.estimate();
+        const double error = (estimate - static_cast<double>(exact)) / static_cast<double>(exact) * 100.0;
+
+        std::cout << std::setw(10) << distinct << std::fixed << std::setprecision(1) << std::setw(14) << set_ms
+                  << std::setw(12) << set_mb << std::setw(12) << hll_ms << std::setw(11) << sketch.memory_bytes() / 1024.0
+                  << std::setw(10) << (sketch.is_sparse() ? "sparse" : "dense") << std::setw(12) << std::llround(estimate)
+                  << std::setprecision(2) << std::setw(8) << error << "%" << std::setprecision(1) << std::setw(8)
+                  << set_ms / hll_ms << "x\n";
+    }
+    std::cout << "  (exact count from the set; a billion distinct values would need ~30 GB of set vs 16 KB of sketch)\n";
+}
+
+void benchmark_merge(std::size_t rows, unsigned threads) {
+    section_header("BENCHMARK: per-thread sketches + SIMD register merge");
+    std::vector<long long> values(rows);
+    std::mt19937_64 rng(23);
+    for (auto& v : values) v = static_cast<long long>(rng() % 5000000);
+
+    std::vector<hll::HyperLogLog> partial(threads);
+    double build_ms = time_ms([&] {
+        std::vector<std::thread> pool;
+        const std::size_t chunk = (rows + threads - 1) / threads;
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                const std::size_t begin = std::min(rows, t * chunk), end = std::min(rows, begin + chunk);
+                partial[t] = hll::distinct(values.begin() + begin, values.begin() + end, [](long long x) { return x; });
+            });
+        }
+        for (auto& th : pool) th.join();
+    }, 1);
+
+    hll::HyperLogLog merged;
+    double merge_ms = time_ms([&] {
+        merged = hll::HyperLogLog{};
+        for (const auto& p : partial) merged.merge(p);
+    });
+    auto single = hll::distinct(values.begin(), values.end(), [](long long x) { return x; });
+
+    const int merges = 100000;
+    hll::HyperLogLog a = partial.front(), b = partial.back();
+    double register_merge_ms = time_ms([&] { for (int i = 0; i < merges; ++i) a.merge(b); }, 1);
+
+    std::cout << "  " << threads << " thread(s) built partial sketches in " << std::fixed << std::setprecision(1)
+              << build_ms << " ms, merged in " << std::setprecision(3) << merge_ms << " ms\n";
+    std::cout << "  merged estimate " << std::llround(merged.estimate()) << " == single-sketch estimate "
+              << std::llround(single.estimate()) << ": " << (merged.serialize() == single.serialize() ? "identical registers" : "DIFFERENT") << '\n';
+    std::cout << "  dense merge of 16384 registers: " << std::setprecision(1)
+              << register_merge_ms * 1e6 / merges << " ns\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t rows = std::size_t{1} << 24;
+    if (argc > 1) rows = std::strtoull(argv[1], nullptr, 10);
+    const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+
+    std::cout << "HyperLogLog Distinct-Count Reducer\n";
+    std::cout << "==================================\n";
+
+    demonstrate_reducer();
+    benchmark_cardinalities(rows);
+    benchmark_merge(rows, threads);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ 16 KB sketch for any cardinality, ~0.8% standard error (precision 14)\n";
+    std::cout << "  ✅ Sparse mode keeps small cardinalities near-exact and tiny\n";
+    std::cout << "  ✅ Merge = byte-wise max: per-thread sketches combine losslessly\n";
+    std::cout << "  ✅ serialize()/deserialize() move sketches between processes\n";
+    return 0;
+}
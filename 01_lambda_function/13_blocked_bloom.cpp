@@ -0,0 +1,261 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 13_blocked_bloom.cpp
+ *
+ * PURPOSE: A pre-filter stage for expensive set-membership predicates.
+ * `is_positive` costs one compare; "id is in a set of 10M ids" costs a hash
+ * table lookup - usually a cache miss - for every row, even the rows that
+ * are not in the set. A Bloom filter answers "definitely not" from a much
+ * smaller structure, so only candidates reach the exact lookup:
+ *
+ *   auto in_set = [&](std::uint32_t id) { return bloom.may_contain(id) && ids.count(id) != 0; };
+ *
+ * BLOCKED LAYOUT (split-block Bloom filter, as in Parquet/Impala):
+ *   - the filter is an array of 256-bit blocks (8 x uint32), two per cache line
+ *   - a key picks ONE block, then sets/tests one bit in each of the 8 words
+ *     (bit = (hash * salt[i]) >> 27)
+ *   - one probe = one cache line, and the 8 words are exactly one AVX2
+ *     register: mullo + srli + sllv build the mask, testc checks it
+ *
+ * BUILD: threads insert disjoint key ranges with relaxed atomic OR, so the
+ * filter comes out identical regardless of the thread count.
+ *
+ * Build: g++ -std=c++14 -O2 13_blocked_bloom.cpp -o 13_bloom_cpp14 -pthread
+ * Run:   ./13_bloom_cpp14 [set_size] [threads]
+ */
+
+namespace bloom {
+
+inline std::uint64_t mix(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+class BlockedBloomFilter {
+public:
+    static constexpr std::size_t kWordsPerBlock = 8;
+
+    BlockedBloomFilter(std::size_t expected_keys, double bits_per_key = 16.0) {
+        num_blocks_ = std::max<std::size_t>(1, static_cast<std::size_t>(expected_keys * bits_per_key / 256.0) + 1);
+        storage_.reset(new std::uint32_t[num_blocks_ * kWordsPerBlock + 16]());
+        // Align blocks to 32 bytes: a block never straddles a cache line
+        words_ = storage_.get();
+        while (reinterpret_cast<std::uintptr_t>(words_) % 32 != 0) ++words_;
+    }
+
+    std::size_t bytes() const { return num_blocks_ * kWordsPerBlock * sizeof(std::uint32_t); }
+
+    void insert(std::uint32_t key) {
+        const std::uint64_t h = mix(key);
+        std::uint32_t* block = block_of(h);
+        std::uint32_t mask[kWordsPerBlock];
+        make_mask(static_cast<std::uint32_t>(h), mask);
+        for (std::size_t i = 0; i < kWordsPerBlock; ++i) block[i] |= mask[i];
+    }
+
+    // Safe to call from several threads at once
+    void insert_concurrent(std::uint32_t key) {
+        const std::uint64_t h = mix(key);
+        std::uint32_t* block = block_of(h);
+        std::uint32_t mask[kWordsPerBlock];
+        make_mask(static_cast<std::uint32_t>(h), mask);
+        for (std::size_t i = 0; i < kWordsPerBlock; ++i) {
+            if ((__atomic_load_n(&block[i], __ATOMIC_RELAXED) & mask[i]) != mask[i]) __atomic_fetch_or(&block[i], mask[i], __ATOMIC_RELAXED);
+        }
+    }
+
+    bool may_contain(std::uint32_t key) const {
+        const std::uint64_t h = mix(key);
+        return test_block(block_of(h), static_cast<std::uint32_t>(h));
+    }
+
+    // Batch probe: hash and prefetch 16 keys, then test them. Writes the
+    // indices of candidate keys to `out` and returns how many there are
+    std::size_t filter_batch(const std::uint32_t* keys, std::size_t n, std::uint32_t* out) const {
+        constexpr std::size_t kBatch = 16;
+        std::size_t count = 0;
+        std::uint64_t hashes[kBatch];
+        for (std::size_t start = 0; start < n; start += kBatch) {
+            const std::size_t m = std::min(kBatch, n - start);
+            for (std::size_t j = 0; j < m; ++j) {
+                hashes[j] = mix(keys[start + j]);
+                __builtin_prefetch(block_of(hashes[j]));
+            }
+            for (std::size_t j = 0; j < m; ++j) {
+                out[count] = static_cast<std::uint32_t>(start + j);
+                count += test_block(block_of(hashes[j]), static_cast<std::uint32_t>(hashes[j])) ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+private:
+    // Upper 32 hash bits pick the block (multiply-shift instead of modulo)
+    std::uint32_t* block_of(std::uint64_t h) const {
+        const std::size_t index = static_cast<std::size_t>(((h >> 32) * num_blocks_) >> 32);
+        return words_ + index * kWordsPerBlock;
+    }
+
+    static void make_mask(std::uint32_t h, std::uint32_t* mask) {
+        static const std::uint32_t salt[kWordsPerBlock] = {0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+                                                           0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+        for (std::size_t i = 0; i < kWordsPerBlock; ++i) mask[i] = 1u << ((h * salt[i]) >> 27);
+    }
+
+    static bool test_block(const std::uint32_t* block, std::uint32_t h) {
+#if defined(__AVX2__)
+        const __m256i salt = _mm256_setr_epi32(0x47b6137b, 0x44974d91, static_cast<int>(0x8824ad5bu), static_cast<int>(0xa2b7289du),
+                                               0x705495c7, 0x2df1424b, static_cast<int>(0x9efc4947u), 0x5c6bfb31);
+        const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(h)), salt), 27);
+        const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+        return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), mask) != 0;
+#else
+        std::uint32_t mask[kWordsPerBlock];
+        make_mask(h, mask);
+        std::uint32_t missing = 0;
+        for (std::size_t i = 0; i < kWordsPerBlock; ++i) missing |= mask[i] & ~block[i];
+        return missing == 0;
+#endif
+    }
+
+    std::unique_ptr<std::uint32_t[]> storage_;
+    std::uint32_t* words_ = nullptr;
+    std::size_t num_blocks_ = 0;
+};
+
+// Parallel build: one contiguous key range per thread
+inline void build_parallel(BlockedBloomFilter& filter, const std::vector<std::uint32_t>& keys, unsigned threads) {
+    if (threads <= 1) {
+        for (std::uint32_t k : keys) filter.insert(k);
+        return;
+    }
+    std::vector<std::thread> pool;
+    const std::size_t chunk = (keys.size() + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            const std::size_t begin = std::min(keys.size(), t * chunk), end = std::min(keys.size(), begin + chunk);
+            for (std::size_t i = begin; i < end; ++i) filter.insert_concurrent(keys[i]);
+        });
+    }
+    for (auto& th : pool) th.join();
+}
+
+}  // namespace bloom
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 3) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+void benchmark_hit_rates(std::size_t set_size, unsigned threads) {
+    section_header("Building the id set");
+    // Ids are even numbers; odd numbers are guaranteed misses
+    std::vector<std::uint32_t> ids(set_size);
+    std::mt19937 rng(31);
+    for (auto& id : ids) id = (rng() >> 1) << 1;
+
+    std::unordered_set<std::uint32_t> exact;
+    double set_build_ms = time_ms([&] {
+        exact = std::unordered_set<std::uint32_t>(ids.begin(), ids.end());
+    }, 1);
+    bloom::BlockedBloomFilter filter(set_size);
+    double bloom_build_ms = time_ms([&] {
+        filter = bloom::BlockedBloomFilter(set_size);
+        bloom::build_parallel(filter, ids, threads);
+    }, 1);
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  unordered_set: " << exact.size() << " ids, built in " << set_build_ms << " ms\n";
+    std::cout << "  blocked Bloom: " << filter.bytes() / (1024.0 * 1024.0) << " MB (16 bits/key), built in "
+              << bloom_build_ms << " ms with " << threads << " thread(s)\n";
+
+    section_header("BENCHMARK: `id in set` predicate at different hit rates");
+    const std::size_t probes = std::size_t{1} << 22;
+    std::cout << "  Probe stream: " << probes << " ids; ms per pass (best of 3), result = matching rows\n\n";
+    std::cout << std::setw(9) << "hit rate" << std::setw(16) << "set.count" << std::setw(16) << "bloom && count"
+              << std::setw(16) << "batch+SIMD" << std::setw(10) << "speedup" << std::setw(12) << "false pos" << "  check\n";
+
+    for (double hit_rate : {0.0, 0.01, 0.10, 0.50, 1.0}) {
+        std::vector<std::uint32_t> stream(probes);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        for (auto& id : stream) id = coin(rng) < hit_rate ? ids[rng() % ids.size()] : (rng() | 1u);
+
+        std::size_t expected = 0, result = 0, candidates = 0;
+        double set_ms = time_ms([&] {
+            expected = 0;
+            for (std::uint32_t id : stream) expected += exact.count(id);
+        });
+
+        auto in_set = [&](std::uint32_t id) { return filter.may_contain(id) && exact.count(id) != 0; };
+        double prefilter_ms = time_ms([&] {
+            result = 0;
+            for (std::uint32_t id : stream) result += in_set(id) ? 1 : 0;
+        });
+        bool ok = result == expected;
+
+        std::vector<std::uint32_t> selection(4096);
+        double batch_ms = time_ms([&] {
+            result = 0;
+            candidates = 0;
+            for (std::size_t start = 0; start < probes; start += selection.size()) {
+                const std::size_t n = std::min(selection.size(), probes - start);
+                const std::size_t c = filter.filter_batch(stream.data() + start, n, selection.data());
+                candidates += c;
+                for (std::size_t k = 0; k < c; ++k) result += exact.count(stream[start + selection[k]]);
+            }
+        });
+        ok = ok && result == expected;
+
+        const std::size_t negatives = probes - expected;
+        const double fpr = negatives ? 100.0 * static_cast<double>(candidates - expected) / static_cast<double>(negatives) : 0.0;
+        std::cout << std::setw(8) << std::setprecision(0) << hit_rate * 100 << "%" << std::setprecision(2)
+                  << std::setw(16) << set_ms << std::setw(16) << prefilter_ms << std::setw(16) << batch_ms
+                  << std::setprecision(1) << std::setw(9) << set_ms / batch_ms << "x" << std::setprecision(3)
+                  << std::setw(11) << fpr << "%  " << (ok ? "OK" : "MISMATCH") << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t set_size = 10000000;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1) set_size = std::strtoull(argv[1], nullptr, 10);
+    if (argc > 2) threads = static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10));
+
+    std::cout << "Blocked Bloom Filter Pre-Filter for Set Membership\n";
+    std::cout << "==================================================\n";
+
+    benchmark_hit_rates(set_size, threads);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ One 256-bit block per key: a probe touches one cache line, tested in one AVX2 register\n";
+    std::cout << "  ✅ Misses are rejected by the filter, so the hash table is only asked about candidates\n";
+    std::cout << "  ✅ Batched probes prefetch blocks and emit a selection vector of candidates\n";
+    std::cout << "  ⚠️ At high hit rates every row still pays the exact lookup: the filter is pure overhead\n";
+    return 0;
+}
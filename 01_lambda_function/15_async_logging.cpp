@@ -0,0 +1,589 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * 15_async_logging.cpp
+ *
+ * PURPOSE: Take logging off the hot path of handlers like Foo::process and
+ * print_sum.
+ *
+ *   std::cout << "print_sum(" << a << ...;   // formats AND writes on the
+ *                                             // calling thread, under a lock
+ *   logger.log(kSumFmt, a, b, a + b);        // copies a 64-byte binary record
+ *                                             // into this thread's ring
+ *
+ * alog::Logger:
+ *   - register_format("print_sum({}, {}) = {}") returns a small id; records
+ *     carry the id plus raw arguments (ints, doubles, literals, short strings)
+ *   - every producer thread gets its own single-producer ring: enqueue is
+ *     two relaxed loads, a 64-byte store and one release store - no locks,
+ *     no shared cache line with other producers
+ *   - a full ring never blocks the producer: the record is DROPPED and
+ *     counted; the formatter reports drops in the log itself
+ *   - one background thread drains all rings, formats "{}" placeholders and
+ *     writes 64 KB at a time
+ *   - flush() waits until everything enqueued before it has been written
+ *
+ * Records from one thread stay in order; records from different threads are
+ * not globally ordered.
+ *
+ * Build: g++ -std=c++14 -O2 15_async_logging.cpp -o 15_async_logging_cpp14 -pthread
+ * Run:   ./15_async_logging_cpp14 [records_per_thread]
+ */
+
+namespace alog {
+
+enum class Arg : std::uint8_t { I64, U64, F64, Literal, Str };
+
+constexpr unsigned kMaxArgs = 6;
+constexpr unsigned kMaxFormats = 1024;
+
+// Exactly one cache line: header (16 bytes) + six 8-byte argument slots
+struct Record {
+    std::uint32_t format;
+    std::uint8_t argc;
+    Arg type[kMaxArgs];
+    std::uint8_t reserved[5];
+    std::uint64_t slot[kMaxArgs];
+};
+static_assert(sizeof(Record) == 64, "Record must fill one cache line");
+
+namespace detail {
+
+inline std::atomic<const char*>* format_table() {
+    static std::atomic<const char*> table[kMaxFormats] = {};
+    return table;
+}
+
+inline std::atomic<std::uint32_t>& format_count() {
+    static std::atomic<std::uint32_t> count{0};
+    return count;
+}
+
+// Slots an argument needs at least: strings take a length slot plus one of text
+template <typename T>
+struct Slots : std::integral_constant<unsigned, std::is_same<T, std::string>::value ? 2 : 1> {};
+
+template <typename... Args>
+constexpr unsigned slot_count() {
+    unsigned n = 0;
+    for (unsigned c : {0u, Slots<Args>::value...}) n += c;
+    return n;
+}
+
+// Each encoder writes below `limit` only; an argument that does not fit is dropped
+inline void encode(Record& r, unsigned& slot, unsigned limit, long long v) {
+    if (slot >= limit) return;
+    r.type[r.argc++] = Arg::I64;
+    r.slot[slot++] = static_cast<std::uint64_t>(v);
+}
+
+inline void encode(Record& r, unsigned& slot, unsigned limit, unsigned long long v) {
+    if (slot >= limit) return;
+    r.type[r.argc++] = Arg::U64;
+    r.slot[slot++] = v;
+}
+
+inline void encode(Record& r, unsigned& slot, unsigned limit, double v) {
+    if (slot >= limit) return;
+    r.type[r.argc++] = Arg::F64;
+    std::memcpy(&r.slot[slot++], &v, sizeof(v));
+}
+
+// Pointer only: string literals and other strings that outlive the logger
+inline void encode(Record& r, unsigned& slot, unsigned limit, const char* s) {
+    if (slot >= limit) return;
+    r.type[r.argc++] = Arg::Literal;
+    r.slot[slot++] = reinterpret_cast<std::uintptr_t>(s);
+}
+
+// Copied inline: length slot + as many 8-byte slots as remain below `limit` (truncates)
+inline void encode(Record& r, unsigned& slot, unsigned limit, const std::string& s) {
+    if (slot >= limit) return;
+    const std::size_t room = (limit - slot - 1) * sizeof(std::uint64_t);
+    const std::size_t len = std::min(s.size(), room);
+    r.type[r.argc++] = Arg::Str;
+    r.slot[slot++] = len;
+    std::memcpy(&r.slot[slot], s.data(), len);
+    slot += static_cast<unsigned>((len + 7) / 8);
+}
+
+template <typename T>
+void encode(Record& r, unsigned& slot, unsigned limit, const T& v,
+            typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type* = nullptr) {
+    encode(r, slot, limit, static_cast<long long>(v));
+}
+
+template <typename T>
+void encode(Record& r, unsigned& slot, unsigned limit, const T& v,
+            typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type* = nullptr) {
+    encode(r, slot, limit, static_cast<unsigned long long>(v));
+}
+
+inline void encode(Record& r, unsigned& slot, unsigned limit, float v) {
+    encode(r, slot, limit, static_cast<double>(v));
+}
+
+inline void append_u64(std::vector<char>& out, std::uint64_t v) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0) out.push_back(digits[--n]);
+}
+
+}  // namespace detail
+
+// Call once per call site, e.g. from a function-local static
+inline std::uint32_t register_format(const char* fmt) {
+    const std::uint32_t id = detail::format_count().fetch_add(1, std::memory_order_relaxed);
+    if (id >= kMaxFormats) {
+        std::fprintf(stderr, "alog: more than %u formats registered\n", kMaxFormats);
+        std::abort();
+    }
+    detail::format_table()[id].store(fmt, std::memory_order_release);
+    return id;
+}
+
+// Single-producer / single-consumer ring; the two indices live on separate lines
+class Ring {
+public:
+    Ring(std::size_t capacity, unsigned thread_index)
+        : records_(capacity), mask_(capacity - 1), thread_index_(thread_index) {}
+
+    // Producer: nullptr when full
+    Record* try_claim() {
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        return &records_[head & mask_];
+    }
+
+    void publish() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: calls fn on every published record, returns how many
+    template <typename F>
+    std::size_t drain(F&& fn) {
+        const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const std::uint64_t head = head_.load(std::memory_order_acquire);
+        for (std::uint64_t i = tail; i != head; ++i) fn(records_[i & mask_]);
+        tail_.store(head, std::memory_order_release);
+        return static_cast<std::size_t>(head - tail);
+    }
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    unsigned thread_index() const { return thread_index_; }
+    std::uint64_t reported_drops = 0;   // Consumer only
+
+private:
+    std::vector<Record> records_;
+    const std::uint64_t mask_;
+    const unsigned thread_index_;
+    char pad0_[64];
+    std::atomic<std::uint64_t> head_{0};
+    std::uint64_t cached_tail_ = 0;
+    std::atomic<std::uint64_t> dropped_{0};
+    char pad1_[64];
+    std::atomic<std::uint64_t> tail_{0};
+    char pad2_[64];
+};
+
+class Logger {
+public:
+    // ring_capacity: records per producer thread, rounded up to a power of two
+    explicit Logger(int fd, std::size_t ring_capacity = 1 << 14)
+        : fd_(fd), id_(next_id().fetch_add(1) + 1), ring_capacity_(round_up_pow2(ring_capacity)) {
+        out_.reserve(kFlushBytes + 4096);
+        formatter_ = std::thread([this] { formatter_loop(); });
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ~Logger() {
+        stop_.store(true, std::memory_order_release);
+        formatter_.join();
+    }
+
+    // Never blocks; false when the record was dropped
+    template <typename... Args>
+    bool log(std::uint32_t format, const Args&... args) {
+        static_assert(detail::slot_count<Args...>() <= kMaxArgs, "alog: arguments need more than 6 slots");
+        Ring& ring = local_ring();
+        Record* r = ring.try_claim();
+        if (r == nullptr) return false;
+        r->format = format;
+        r->argc = 0;
+        // Each argument stops short of the slots the ones after it need, so a
+        // long string is truncated instead of crowding them out
+        const unsigned cost[] = {detail::Slots<Args>::value..., 0};
+        unsigned after = detail::slot_count<Args...>();
+        unsigned slot = 0, i = 0;
+        int expand[] = {0, (after -= cost[i++], detail::encode(*r, slot, kMaxArgs - after, args), 0)...};
+        (void)expand;
+        ring.publish();
+        return true;
+    }
+
+    // Returns once every record enqueued before the call has been written
+    void flush() {
+        const std::uint64_t ticket = flush_requested_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (flush_completed_.load(std::memory_order_acquire) < ticket) std::this_thread::yield();
+    }
+
+    std::uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        std::uint64_t total = 0;
+        for (const auto& ring : rings_) total += ring->dropped();
+        return total;
+    }
+
+    std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    std::size_t ring_capacity() const { return ring_capacity_; }
+
+private:
+    static constexpr std::size_t kFlushBytes = 1 << 16;
+
+    static std::atomic<std::uint64_t>& next_id() {
+        static std::atomic<std::uint64_t> id{0};
+        return id;
+    }
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    // Registration takes the mutex once per thread per logger. The per-thread
+    // map has one entry per logger this thread has logged to (ids are never
+    // reused), so alternating between loggers finds the existing ring
+    Ring& local_ring() {
+        struct Entry {
+            std::uint64_t owner;
+            Ring* ring;
+        };
+        thread_local std::vector<Entry> rings;
+        thread_local Entry* last = nullptr;
+        if (last != nullptr && last->owner == id_) return *last->ring;
+        for (auto& entry : rings) {
+            if (entry.owner == id_) {
+                last = &entry;
+                return *entry.ring;
+            }
+        }
+        Ring* ring;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings_.push_back(std::unique_ptr<Ring>(new Ring(ring_capacity_, static_cast<unsigned>(rings_.size()))));
+            ring_count_.store(rings_.size(), std::memory_order_release);
+            ring = rings_.back().get();
+        }
+        rings.push_back({id_, ring});
+        last = &rings.back();
+        return *ring;
+    }
+
+    void format(const Record& r) {
+        const char* fmt = detail::format_table()[r.format].load(std::memory_order_acquire);
+        unsigned arg = 0, slot = 0;
+        for (const char* p = fmt; *p != '\0'; ++p) {
+            if (p[0] != '{' || p[1] != '}' || arg >= r.argc || slot >= kMaxArgs) {
+                out_.push_back(*p);
+                continue;
+            }
+            ++p;
+            const std::uint64_t v = r.slot[slot++];
+            switch (r.type[arg++]) {
+                case Arg::I64:
+                    if (static_cast<std::int64_t>(v) < 0) {
+                        out_.push_back('-');
+                        detail::append_u64(out_, 0 - v);
+                    } else {
+                        detail::append_u64(out_, v);
+                    }
+                    break;
+                case Arg::U64:
+                    detail::append_u64(out_, v);
+                    break;
+                case Arg::F64: {
+                    double d;
+                    std::memcpy(&d, &v, sizeof(d));
+                    char tmp[32];
+                    const int n = std::snprintf(tmp, sizeof(tmp), "%g", d);
+                    out_.insert(out_.end(), tmp, tmp + n);
+                    break;
+                }
+                case Arg::Literal: {
+                    const char* s = reinterpret_cast<const char*>(static_cast<std::uintptr_t>(v));
+                    out_.insert(out_.end(), s, s + std::strlen(s));
+                    break;
+                }
+                case Arg::Str: {
+                    const std::size_t len = std::min<std::uint64_t>(v, (kMaxArgs - slot) * sizeof(std::uint64_t));
+                    const char* s = reinterpret_cast<const char*>(&r.slot[slot]);
+                    out_.insert(out_.end(), s, s + len);
+                    slot += static_cast<unsigned>((len + 7) / 8);
+                    break;
+                }
+            }
+        }
+        out_.push_back('\n');
+        if (out_.size() >= kFlushBytes) write_out();
+    }
+
+    void write_out() {
+        std::size_t done = 0;
+        while (done < out_.size()) {
+            const ssize_t n = ::write(fd_, out_.data() + done, out_.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;   // Nowhere to report a failing log sink: discard
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        out_.clear();
+    }
+
+    // One pass over every ring; returns the number of records formatted
+    std::size_t drain_all() {
+        std::size_t count = 0;
+        const std::size_t rings = ring_count_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < rings; ++i) {
+            Ring* ring;
+            {
+                std::lock_guard<std::mutex> lock(rings_mutex_);
+                ring = rings_[i].get();
+            }
+            count += ring->drain([this](const Record& r) { format(r); });
+            const std::uint64_t dropped = ring->dropped();
+            if (dropped != ring->reported_drops) {
+                char tmp[96];
+                const int n = std::snprintf(tmp, sizeof(tmp), "[alog] thread %u dropped %llu records\n",
+                                            ring->thread_index(),
+                                            static_cast<unsigned long long>(dropped - ring->reported_drops));
+                out_.insert(out_.end(), tmp, tmp + n);
+                ring->reported_drops = dropped;
+            }
+        }
+        written_.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    void formatter_loop() {
+        for (;;) {
+            const bool stopping = stop_.load(std::memory_order_acquire);
+            const std::uint64_t ticket = flush_requested_.load(std::memory_order_acquire);
+            const std::size_t count = drain_all();
+            if (count == 0 || ticket != flush_completed_.load(std::memory_order_relaxed)) {
+                // Idle or asked to flush: drain once more (records enqueued
+                // before the ticket are now visible), then write everything
+                drain_all();
+                write_out();
+                flush_completed_.store(ticket, std::memory_order_release);
+                if (stopping) return;
+                if (count == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    int fd_;
+    std::uint64_t id_;
+    std::size_t ring_capacity_;
+    mutable std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::atomic<std::size_t> ring_count_{0};
+    std::vector<char> out_;
+    std::atomic<bool> stop_{false};
+    std::atomic<std::uint64_t> flush_requested_{0};
+    std::atomic<std::uint64_t> flush_completed_{0};
+    std::atomic<std::uint64_t> written_{0};
+    std::thread formatter_;
+};
+
+}  // namespace alog
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 3) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+// Handlers from 04_lambda_replace_bind.cpp, instrumented with the async logger
+alog::Logger* g_log = nullptr;
+
+void print_sum(int a, int b) {
+    static const std::uint32_t fmt = alog::register_format("print_sum({}, {}) = {}");
+    g_log->log(fmt, a, b, a + b);
+}
+
+class Foo {
+public:
+    void process(const std::string& data) {
+        static const std::uint32_t fmt = alog::register_format("Foo::process('{}') [{}] scale={}");
+        g_log->log(fmt, data, "ok", scale_);
+    }
+
+private:
+    double scale_ = 1.5;
+};
+
+void demonstrate_logger() {
+    section_header("Instrumented handlers");
+    std::cout.flush();   // The logger writes to fd 1 directly
+    {
+        alog::Logger logger(STDOUT_FILENO);
+        g_log = &logger;
+        Foo foo;
+        std::thread worker([&] {
+            for (int i = 0; i < 3; ++i) print_sum(10 * i, i);
+        });
+        foo.process("hello world");
+        foo.process("a string longer than the room left in one 64-byte alog record");
+        worker.join();
+        logger.flush();
+        g_log = nullptr;
+    }
+    std::cout << "  (strings are copied inline and truncated to fit one 64-byte record)\n";
+}
+
+void benchmark_logging(std::size_t per_thread) {
+    section_header("BENCHMARK: enqueue cost (single thread, ring never full)");
+    const int null_fd = ::open("/dev/null", O_WRONLY);
+    {
+        alog::Logger logger(null_fd, 1 << 16);
+        static const std::uint32_t fmt = alog::register_format("print_sum({}, {}) = {}");
+        const int batch = 1 << 15;   // Half the ring: the formatter is flushed between batches
+        double best_ns = 1e300;
+        for (int rep = 0; rep < 20; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < batch; ++i) logger.log(fmt, i, 2, i + 2);
+            auto stop = std::chrono::steady_clock::now();
+            best_ns = std::min(best_ns, std::chrono::duration<double, std::nano>(stop - start).count() / batch);
+            logger.flush();
+        }
+        std::cout << "  alog::Logger::log(fmt, int, int, int): " << std::fixed << std::setprecision(1) << best_ns
+                  << " ns per record (target < 50 ns), dropped " << logger.dropped() << '\n';
+    }
+
+    const unsigned threads = 16;
+    section_header("BENCHMARK: 16 threads logging print_sum");
+    std::cout << "  " << per_thread << " records per thread, written to /dev/null (best of 3)\n\n";
+
+    std::ofstream null_stream("/dev/null");
+    std::streambuf* saved = std::cout.rdbuf(null_stream.rdbuf());
+    auto run_threads = [&](auto&& body) {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) pool.emplace_back([&, t] { body(t); });
+        for (auto& th : pool) th.join();
+    };
+
+    std::mutex cout_mutex;
+    const double cout_endl_ms = time_ms([&] {
+        run_threads([&](unsigned t) {
+            for (std::size_t i = 0; i < per_thread; ++i) {
+                std::lock_guard<std::mutex> lock(cout_mutex);
+                std::cout << "print_sum(" << t << ", " << i << ") = " << t + i << std::endl;
+            }
+        });
+    });
+    const double cout_ms = time_ms([&] {
+        run_threads([&](unsigned t) {
+            for (std::size_t i = 0; i < per_thread; ++i) {
+                std::lock_guard<std::mutex> lock(cout_mutex);
+                std::cout << "print_sum(" << t << ", " << i << ") = " << t + i << '\n';
+            }
+        });
+    });
+    std::cout.rdbuf(saved);
+
+    std::cout << "  " << std::left << std::setw(32) << "" << std::right << std::setw(14) << "producers ms" << std::setw(14)
+              << "total ms" << std::setw(10) << "written" << std::setw(10) << "dropped" << std::setw(9) << "speedup\n";
+    auto row = [&](const std::string& name, double producers_ms, double total_ms, std::uint64_t written, std::uint64_t dropped) {
+        std::cout << "  " << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << producers_ms << std::setw(14) << total_ms << std::setw(10) << written
+                  << std::setw(10) << dropped << std::setw(8) << cout_endl_ms / total_ms << "x\n";
+    };
+    const std::uint64_t all = threads * per_thread;
+    row("std::cout + mutex + std::endl", cout_endl_ms, cout_endl_ms, all, 0);
+    row("std::cout + mutex + '\\n'", cout_ms, cout_ms, all, 0);
+
+    // Small rings drop most of a burst; rings that hold the whole burst drop nothing
+    for (std::size_t ring : {std::size_t{1} << 10, per_thread}) {
+        double producers_ms = 1e300, total_ms = 1e300;
+        std::uint64_t dropped = 0, written = 0;
+        std::size_t capacity = 0;
+        for (int rep = 0; rep < 3; ++rep) {
+            alog::Logger logger(null_fd, ring);
+            static const std::uint32_t fmt = alog::register_format("print_sum({}, {}) = {}");
+            auto start = std::chrono::steady_clock::now();
+            run_threads([&](unsigned t) {
+                for (std::size_t i = 0; i < per_thread; ++i) logger.log(fmt, t, i, t + i);
+            });
+            auto produced = std::chrono::steady_clock::now();
+            logger.flush();
+            auto stop = std::chrono::steady_clock::now();
+            producers_ms = std::min(producers_ms, std::chrono::duration<double, std::milli>(produced - start).count());
+            total_ms = std::min(total_ms, std::chrono::duration<double, std::milli>(stop - start).count());
+            dropped = logger.dropped();
+            written = logger.written();
+            capacity = logger.ring_capacity();
+        }
+        row("alog, " + std::to_string(capacity) + "-record rings", producers_ms, total_ms, written, dropped);
+    }
+    ::close(null_fd);
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t per_thread = 100000;
+    if (argc > 1) per_thread = std::strtoull(argv[1], nullptr, 10);
+
+    std::cout << "Asynchronous Lock-Free Logging\n";
+    std::cout << "==============================\n";
+
+    demonstrate_logger();
+    benchmark_logging(per_thread);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ The hot path copies a 64-byte record; formatting and write() happen elsewhere\n";
+    std::cout << "  ✅ Per-thread rings: producers never share a lock or a written cache line\n";
+    std::cout << "  ✅ A full ring drops and counts instead of stalling the handler\n";
+    std::cout << "  ⚠️ Small rings drop under bursts; size them for the burst, not the average\n";
+    std::cout << "  ⚠️ Formatting still costs CPU: on one core the total gain is much smaller than the enqueue gain\n";
+    std::cout << "  ⚠️ Literal (const char*) arguments are stored by pointer and must outlive the logger\n";
+    return 0;
+}
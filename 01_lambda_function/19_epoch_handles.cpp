@@ -0,0 +1,473 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * 19_epoch_handles.cpp
+ *
+ * PURPOSE: Bind callbacks to a shared object without touching a reference
+ * count on every copy.
+ *
+ *   std::function<void(const std::string&)> f =
+ *       std::bind(&Foo::process, sp, _1);    // copy: atomic ++ on sp's control
+ *                                           // block, destroy: atomic --; all
+ *                                           // threads hit the SAME cache line
+ *   auto h = owner.handle();               // {cell*, generation}: 16 bytes
+ *   f = [h](const std::string& s) {        // copy: memcpy, no atomics
+ *       epoch::Guard g;                    // pin: a store to THIS thread's slot
+ *       if (Foo* foo = h.get()) foo->process(s);
+ *   };
+ *
+ * EPOCH-BASED RECLAMATION: epoch::Owner<T> owns the object. Resetting the
+ * owner unlinks the object (its cell's generation changes, so every handle
+ * now reads nullptr) and RETIRES it. A retired object is freed only after
+ * the global epoch has advanced twice, which requires every thread that was
+ * inside a Guard at retirement to have left it. Readers never write shared
+ * memory; only the owner and the collector do.
+ *
+ * Build: g++ -std=c++14 -O2 19_epoch_handles.cpp -o 19_epoch_cpp14 -pthread
+ * Run:   ./19_epoch_cpp14 [operations_per_thread] [threads]
+ */
+
+namespace epoch {
+
+class Domain {
+public:
+    static constexpr unsigned kMaxThreads = 256;
+
+    Domain() : id_(next_id().fetch_add(1) + 1) {}
+    Domain(const Domain&) = delete;
+    Domain& operator=(const Domain&) = delete;
+
+    // Threads that used the domain must have exited (or be this thread)
+    ~Domain() {
+        auto& entries = local_cache().entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry& e) { return e.owner == id_; }),
+                      entries.end());
+        for (auto& r : limbo_) r.destroy(r.object);
+    }
+
+    // Enter a read-side critical section (nestable)
+    void pin() {
+        Slot& slot = local_slot();
+        if (slot.depth++ == 0) {
+            slot.state.store((global_.load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);   // Announce before reading shared data
+        }
+    }
+
+    void unpin() {
+        Slot& slot = local_slot();
+        if (--slot.depth == 0) slot.state.store(0, std::memory_order_release);
+    }
+
+    // Frees `destroy(object)` once no thread can still be reading it
+    void retire(void* object, void (*destroy)(void*)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limbo_.push_back({object, destroy, global_.load(std::memory_order_seq_cst)});
+        collect_locked();
+    }
+
+    // Advances the epoch if every pinned thread has seen it; frees what is safe
+    void collect() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        collect_locked();
+    }
+
+    std::size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return limbo_.size();
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> state{0};   // (epoch << 1) | 1 while pinned, 0 when idle
+        std::atomic<bool> claimed{false};
+        unsigned depth = 0;                    // Owner thread only
+    };
+
+    // One slot per thread per domain, so guards on different domains nest;
+    // handed back when the thread exits
+    struct Entry {
+        std::uint64_t owner;
+        Slot* slot;
+    };
+    struct Cache {
+        std::vector<Entry> entries;
+        std::size_t last = 0;   // Index of the most recently used entry
+        ~Cache() {
+            for (auto& e : entries) e.slot->claimed.store(false, std::memory_order_release);
+        }
+    };
+
+    static Cache& local_cache() {
+        thread_local Cache cache;
+        return cache;
+    }
+
+    struct Retired {
+        void* object;
+        void (*destroy)(void*);
+        std::uint64_t epoch;
+    };
+
+    static std::atomic<std::uint64_t>& next_id() {
+        static std::atomic<std::uint64_t> id{0};
+        return id;
+    }
+
+    Slot& local_slot() {
+        Cache& cache = local_cache();
+        if (cache.last < cache.entries.size() && cache.entries[cache.last].owner == id_)
+            return *cache.entries[cache.last].slot;
+        for (std::size_t e = 0; e < cache.entries.size(); ++e) {
+            if (cache.entries[e].owner == id_) {
+                cache.last = e;
+                return *cache.entries[e].slot;
+            }
+        }
+        for (unsigned i = 0; i < kMaxThreads; ++i) {
+            bool expected = false;
+            if (!slots_[i].claimed.load(std::memory_order_relaxed) &&
+                slots_[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                unsigned seen = registered_.load(std::memory_order_relaxed);
+                while (seen < i + 1 && !registered_.compare_exchange_weak(seen, i + 1, std::memory_order_acq_rel)) {
+                }
+                cache.entries.push_back({id_, &slots_[i]});
+                cache.last = cache.entries.size() - 1;
+                return slots_[i];
+            }
+        }
+        std::cerr << "epoch::Domain: more than " << kMaxThreads << " threads\n";
+        std::abort();
+    }
+
+    void collect_locked() {
+        const std::uint64_t epoch = global_.load(std::memory_order_seq_cst);
+        const unsigned threads = std::min<unsigned>(registered_.load(std::memory_order_acquire), unsigned{kMaxThreads});
+        for (unsigned i = 0; i < threads; ++i) {
+            const std::uint64_t state = slots_[i].state.load(std::memory_order_seq_cst);
+            if ((state & 1) && (state >> 1) != epoch) return;   // A reader is still in an older epoch
+        }
+        global_.store(epoch + 1, std::memory_order_seq_cst);
+        // Retired in epoch e: every reader that could see it has left once the global epoch is e + 2
+        auto safe = std::partition(limbo_.begin(), limbo_.end(), [&](const Retired& r) { return r.epoch + 2 > epoch + 1; });
+        for (auto it = safe; it != limbo_.end(); ++it) it->destroy(it->object);
+        limbo_.erase(safe, limbo_.end());
+    }
+
+    const std::uint64_t id_;
+    std::atomic<std::uint64_t> global_{0};
+    std::atomic<unsigned> registered_{0};   // High-water mark of claimed slots
+    Slot slots_[kMaxThreads];
+    mutable std::mutex mutex_;
+    std::vector<Retired> limbo_;
+};
+
+// Process-wide domain, so closures need not capture one
+inline Domain& default_domain() {
+    static Domain domain;
+    return domain;
+}
+
+class Guard {
+public:
+    Guard() : Guard(default_domain()) {}
+    explicit Guard(Domain& domain) : domain_(domain) { domain_.pin(); }
+    ~Guard() { domain_.unpin(); }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+private:
+    Domain& domain_;
+};
+
+// Indirection every handle points at; recycled only after a grace period
+struct Cell {
+    std::atomic<void*> object{nullptr};
+    std::atomic<std::uint32_t> generation{0};
+};
+
+class CellPool {
+public:
+    // Never destroyed: a static Domain's destructor may still retire into it
+    static CellPool& instance() {
+        static CellPool& pool = *new CellPool;
+        return pool;
+    }
+
+    Cell* acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            cells_.emplace_back();
+            return &cells_.back();
+        }
+        Cell* cell = free_.back();
+        free_.pop_back();
+        return cell;
+    }
+
+    void release(Cell* cell) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(cell);
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<Cell> cells_;   // Stable addresses
+    std::vector<Cell*> free_;
+};
+
+// Borrowed reference: trivially copyable, no reference count
+template <typename T>
+class Handle {
+public:
+    Handle() = default;
+    Handle(Cell* cell, std::uint32_t generation) : cell_(cell), generation_(generation) {}
+
+    // Only valid inside a Guard; nullptr once the owner has been reset
+    T* get() const {
+        if (cell_ == nullptr || cell_->generation.load(std::memory_order_acquire) != generation_) return nullptr;
+        return static_cast<T*>(cell_->object.load(std::memory_order_acquire));
+    }
+
+    T* operator->() const { return get(); }
+
+private:
+    Cell* cell_ = nullptr;
+    std::uint32_t generation_ = 0;
+};
+
+template <typename T>
+class Owner {
+public:
+    Owner(Domain& domain, std::unique_ptr<T> object) : domain_(&domain), cell_(CellPool::instance().acquire()) {
+        generation_ = cell_->generation.load(std::memory_order_relaxed);
+        cell_->object.store(object.release(), std::memory_order_release);
+    }
+
+    Owner(Owner&& other) noexcept : domain_(other.domain_), cell_(other.cell_), generation_(other.generation_) {
+        other.cell_ = nullptr;
+    }
+    Owner(const Owner&) = delete;
+    Owner& operator=(const Owner&) = delete;
+
+    ~Owner() { reset(); }
+
+    Handle<T> handle() const { return Handle<T>(cell_, generation_); }
+
+    // Unlinks the object now; it is destroyed after every current reader leaves
+    void reset() {
+        if (cell_ == nullptr) return;
+        struct Retired {
+            static void destroy(void* p) {
+                auto* pair = static_cast<std::pair<T*, Cell*>*>(p);
+                delete pair->first;
+                CellPool::instance().release(pair->second);
+                delete pair;
+            }
+        };
+        T* object = static_cast<T*>(cell_->object.exchange(nullptr, std::memory_order_seq_cst));
+        cell_->generation.fetch_add(1, std::memory_order_seq_cst);
+        domain_->retire(new std::pair<T*, Cell*>(object, cell_), &Retired::destroy);
+        cell_ = nullptr;
+    }
+
+private:
+    Domain* domain_;
+    Cell* cell_;
+    std::uint32_t generation_ = 0;
+};
+
+template <typename T, typename... Args>
+Owner<T> make_owned(Domain& domain, Args&&... args) {
+    return Owner<T>(domain, std::unique_ptr<T>(new T(std::forward<Args>(args)...)));
+}
+
+template <typename T, typename... Args>
+Owner<T> make_owned(Args&&... args) {
+    return make_owned<T>(default_domain(), std::forward<Args>(args)...);
+}
+
+}  // namespace epoch
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 3) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+// Foo from 04_lambda_replace_bind.cpp: read-only work so only the handle traffic differs
+class Foo {
+public:
+    explicit Foo(std::uint64_t seed) : seed_(seed) {}
+    ~Foo() { ++destroyed; }
+
+    std::uint64_t process(const std::string& data) const {
+        std::uint64_t h = seed_;
+        for (char c : data) h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ULL;
+        return h;
+    }
+
+    static std::atomic<int> destroyed;
+
+private:
+    std::uint64_t seed_;
+};
+
+std::atomic<int> Foo::destroyed{0};
+
+void demonstrate_lifetime() {
+    section_header("Handles outlive the object safely");
+    epoch::Domain domain;
+    auto owner = epoch::make_owned<Foo>(domain, 7);
+    auto h = owner.handle();
+    std::function<bool(const std::string&)> callback = [h, &domain](const std::string& s) {
+        epoch::Guard guard(domain);
+        if (const Foo* foo = h.get()) return foo->process(s) != 0;
+        return false;
+    };
+    std::cout << "  callback(\"event\") with the owner alive:  " << std::boolalpha << callback("event") << '\n';
+
+    const int before = Foo::destroyed.load();
+    bool during = false;
+    {
+        epoch::Guard reader(domain);   // A reader inside its critical section
+        const Foo* seen = h.get();
+        owner.reset();                 // Unlinked and retired, but not freed yet
+        during = seen != nullptr && Foo::destroyed.load() == before;
+        std::cout << "  reset() while a reader is pinned:        handle now " << (h.get() ? "non-null" : "nullptr")
+                  << ", object " << (during ? "still alive" : "FREED") << " (" << domain.pending() << " pending)\n";
+    }
+    domain.collect();
+    domain.collect();
+    std::cout << "  after the reader left + 2 epochs:        destroyed " << Foo::destroyed.load() - before
+              << ", pending " << domain.pending() << '\n';
+    std::cout << "  callback(\"event\") after reset:           " << callback("event") << "  (no dangling pointer)\n";
+}
+
+void benchmark_copies(std::size_t ops, unsigned threads) {
+    section_header("BENCHMARK: copy a callback into std::function, then invoke it");
+    std::cout << "  " << ops << " copy+invoke per thread, all bound to ONE Foo (best of 3, ns per operation)\n\n";
+
+    auto shared = std::make_shared<Foo>(11);
+    auto owner = epoch::make_owned<Foo>(11);   // Default domain: closures capture only the handle
+    const epoch::Handle<Foo> handle = owner.handle();
+    const Foo* raw = shared.get();
+    const std::string event = "button_click";
+
+    using Callback = std::function<std::uint64_t(const std::string&)>;
+    const Callback via_bind = std::bind(&Foo::process, shared, std::placeholders::_1);
+    const Callback via_shared_lambda = [sp = shared](const std::string& s) { return sp->process(s); };
+    const Callback via_handle = [handle](const std::string& s) {
+        epoch::Guard guard;
+        const Foo* foo = handle.get();
+        return foo ? foo->process(s) : 0;
+    };
+    const Callback via_raw = [raw](const std::string& s) { return raw->process(s); };
+    auto shared_closure = [sp = shared](const std::string& s) { return sp->process(s); };
+
+    std::atomic<std::uint64_t> checksum{0};
+    auto run = [&](unsigned thread_count, auto body) {
+        return time_ms([&] {
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < thread_count; ++t) {
+                pool.emplace_back([&] {
+                    std::uint64_t sum = 0;
+                    body(sum);
+                    checksum.fetch_add(sum, std::memory_order_relaxed);
+                });
+            }
+            for (auto& th : pool) th.join();
+        }) * 1e6 / static_cast<double>(ops * thread_count);
+    };
+    auto copy_invoke = [&](const Callback& prototype) {
+        return [&](std::uint64_t& sum) {
+            for (std::size_t i = 0; i < ops; ++i) {
+                Callback copy = prototype;   // The copy under test
+                sum += copy(event);
+            }
+        };
+    };
+
+    struct Row {
+        std::string name;
+        std::function<void(std::uint64_t&)> body;
+    };
+    std::vector<Row> rows = {
+        {"std::bind(&Foo::process, shared_ptr, _1)", copy_invoke(via_bind)},
+        {"[sp = shared_ptr] lambda", copy_invoke(via_shared_lambda)},
+        {"[sp] closure copied (no std::function)", [&](std::uint64_t& sum) {
+             for (std::size_t i = 0; i < ops; ++i) {
+                 auto copy = shared_closure;
+                 sum += copy(event);
+             }
+         }},
+        {"[handle] lambda, Guard per call", copy_invoke(via_handle)},
+        {"[handle] lambda, Guard per batch", [&](std::uint64_t& sum) {
+             epoch::Guard guard;   // Nested Guards inside the calls are nearly free
+             for (std::size_t i = 0; i < ops; ++i) {
+                 Callback copy = via_handle;
+                 sum += copy(event);
+             }
+         }},
+        {"[raw pointer] lambda (unsafe baseline)", copy_invoke(via_raw)},
+    };
+
+    std::cout << "  " << std::left << std::setw(44) << "" << std::right << std::setw(12) << "1 thread" << std::setw(12)
+              << (std::to_string(threads) + " threads") << '\n';
+    for (const auto& row : rows) {
+        const double one = run(1, row.body);
+        const double many = run(threads, row.body);
+        std::cout << "  " << std::left << std::setw(44) << row.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << one << std::setw(12) << many << '\n';
+    }
+    std::cout << "\n  shared_ptr use_count after the runs: " << shared.use_count() << " (checksum " << std::hex
+              << (checksum.load() & 0xFFFF) << std::dec << ")\n";
+    std::cout << "  hardware threads: " << std::thread::hardware_concurrency()
+              << (std::thread::hardware_concurrency() <= 1 ? "  (threads time-slice: the refcount line never ping-pongs here)" : "")
+              << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t ops = 200000;
+    unsigned threads = 32;
+    if (argc > 1) ops = std::strtoull(argv[1], nullptr, 10);
+    if (argc > 2) threads = static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10));
+
+    std::cout << "Epoch-Protected Handles vs shared_ptr Captures\n";
+    std::cout << "==============================================\n";
+
+    demonstrate_lifetime();
+    benchmark_copies(ops, threads);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ Copying a handle closure is a 16-byte copy: no atomics, and it fits std::function's small buffer\n";
+    std::cout << "  ✅ Guards write only the calling thread's slot; readers share no written cache line\n";
+    std::cout << "  ✅ reset() never frees under a reader: the object waits in limbo for two epochs\n";
+    std::cout << "  ⚠️ shared_ptr captures are not trivially copyable: std::function heap-allocates them on every copy\n";
+    std::cout << "  ⚠️ A thread parked inside a Guard stalls reclamation (memory grows, nothing breaks)\n";
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <string>
+#include <new>
+#include <utility>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * 20_slot_map.cpp
+ *
+ * PURPOSE: Safe replacements for [&foo] captures in callbacks that may
+ * outlive foo, without weak_ptr::lock() on every call.
+ *
+ *   [&foo](int x) { foo.process(x); }          // dangles once foo is gone
+ *   [wp](int x) { if (auto sp = wp.lock())      // atomic CAS on lock, atomic
+ *                     sp->process(x); }         // decrement when sp dies
+ *   [h, &foos](int x) { if (Foo* f = foos.get(h)) f->process(x); }
+ *                                               // one load + compare
+ *
+ * slot::SlotMap<T> stores objects in fixed 1024-slot blocks (objects never
+ * move) and keeps a flat array of 32-bit generations next to them. A handle
+ * is {index, generation}: 8 bytes, trivially copyable.
+ *
+ *   generation is ODD while the slot is occupied, EVEN while free
+ *   erase:   destroy the object, ++generation      -> every old handle is stale
+ *   emplace: reuse a free slot, ++generation       -> new handles only match new
+ *   get(h):  generations_[h.index] == h.generation ? object : nullptr
+ *
+ * Single-threaded, like the callbacks it serves; see 19_epoch_handles.cpp for
+ * objects shared across threads.
+ *
+ * Build: g++ -std=c++14 -O2 20_slot_map.cpp -o 20_slot_map_cpp14
+ * Run:   ./20_slot_map_cpp14 [invocations]
+ */
+
+namespace slot {
+
+struct Handle {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;   // 0 is never occupied: a default Handle is always stale
+};
+
+template <typename T>
+class SlotMap {
+public:
+    static constexpr std::uint32_t kBlockBits = 10;
+    static constexpr std::uint32_t kBlockSize = 1u << kBlockBits;
+
+    SlotMap() = default;
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    ~SlotMap() {
+        for (std::uint32_t i = 0; i < generations_.size(); ++i)
+            if (generations_[i] & 1) object(i)->~T();
+    }
+
+    template <typename... Args>
+    Handle emplace(Args&&... args) {
+        std::uint32_t index;
+        if (free_head_ != kNone) {
+            index = free_head_;
+            free_head_ = next_free_[index];
+        } else {
+            index = static_cast<std::uint32_t>(generations_.size());
+            if ((index & (kBlockSize - 1)) == 0) blocks_.emplace_back(new Block);
+            generations_.push_back(0);
+            next_free_.push_back(std::uint32_t{kNone});   // A copy: no ODR-use of kNone before C++17
+        }
+        new (object(index)) T(std::forward<Args>(args)...);
+        ++generations_[index];   // Even -> odd: occupied
+        ++size_;
+        return Handle{index, generations_[index]};
+    }
+
+    // false if the handle was already stale
+    bool erase(Handle h) {
+        if (!contains(h)) return false;
+        object(h.index)->~T();
+        ++generations_[h.index];   // Odd -> even: every handle to it is now stale
+        next_free_[h.index] = free_head_;
+        free_head_ = h.index;
+        --size_;
+        return true;
+    }
+
+    // The single load + compare
+    bool contains(Handle h) const {
+        return h.index < generations_.size() && generations_[h.index] == h.generation;
+    }
+
+    T* get(Handle h) { return contains(h) ? object(h.index) : nullptr; }
+    const T* get(Handle h) const { return contains(h) ? object(h.index) : nullptr; }
+
+    std::size_t size() const { return size_; }
+
+    template <typename F>
+    void for_each(F&& fn) {
+        for (std::uint32_t i = 0; i < generations_.size(); ++i)
+            if (generations_[i] & 1) fn(*object(i));
+    }
+
+private:
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    struct Block {
+        alignas(T) unsigned char storage[kBlockSize * sizeof(T)];
+    };
+
+    T* object(std::uint32_t index) const {
+        return reinterpret_cast<T*>(blocks_[index >> kBlockBits]->storage) + (index & (kBlockSize - 1));
+    }
+
+    std::vector<std::uint32_t> generations_;
+    std::vector<std::uint32_t> next_free_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+    std::uint32_t free_head_ = kNone;
+    std::size_t size_ = 0;
+};
+
+}  // namespace slot
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+// Foo from 04_lambda_replace_bind.cpp, reduced to a counter
+class Foo {
+public:
+    explicit Foo(std::string name) : name_(std::move(name)) {}
+    void process(int x) { total_ += x; }
+    long long total() const { return total_; }
+    const std::string& name() const { return name_; }
+
+private:
+    std::string name_;
+    long long total_ = 0;
+};
+
+void demonstrate_handles() {
+    section_header("Callbacks that outlive their object");
+    slot::SlotMap<Foo> foos;
+    const slot::Handle a = foos.emplace("sensor_a");
+    const slot::Handle b = foos.emplace("sensor_b");
+
+    std::vector<std::function<void(int)>> callbacks;
+    for (slot::Handle h : {a, b}) {
+        callbacks.push_back([h, &foos](int x) {
+            if (Foo* foo = foos.get(h)) foo->process(x);
+            else std::cout << "    (skipped: handle {" << h.index << ", " << h.generation << "} is stale)\n";
+        });
+    }
+
+    for (auto& cb : callbacks) cb(10);
+    std::cout << "  erase(sensor_a); emplace(sensor_c) reuses its slot\n";
+    foos.erase(a);
+    const slot::Handle c = foos.emplace("sensor_c");
+    std::cout << "  sensor_c: {" << c.index << ", " << c.generation << "}, old sensor_a handle: {" << a.index << ", "
+              << a.generation << "}\n";
+    for (auto& cb : callbacks) cb(5);
+    foos.for_each([](const Foo& foo) { std::cout << "    " << foo.name() << " total " << foo.total() << '\n'; });
+    std::cout << "  A [&foo] capture of sensor_a would now have written into sensor_c (or freed memory)\n";
+}
+
+void benchmark_invocation(std::size_t invocations) {
+    section_header("BENCHMARK: validate + invoke per call");
+    const std::size_t objects = 10000;
+
+    std::vector<std::shared_ptr<Foo>> shared;
+    std::vector<std::weak_ptr<Foo>> weak;
+    slot::SlotMap<Foo> foos;
+    std::vector<slot::Handle> handles;
+    std::vector<Foo> plain;   // The raw-pointer baseline gets its own objects
+    std::vector<Foo*> raw;
+    plain.reserve(objects);
+    for (std::size_t i = 0; i < objects; ++i) {
+        shared.push_back(std::make_shared<Foo>("foo" + std::to_string(i)));
+        weak.push_back(shared.back());
+        handles.push_back(foos.emplace("foo" + std::to_string(i)));
+        plain.emplace_back("foo" + std::to_string(i));
+        raw.push_back(&plain.back());
+    }
+
+    // Callback order: random over the objects, identical for every variant
+    std::vector<std::uint32_t> order(invocations);
+    std::mt19937 rng(5);
+    for (auto& o : order) o = static_cast<std::uint32_t>(rng() % objects);
+
+    auto run = [&](auto&& invoke) {
+        return time_ms([&] {
+            for (std::size_t i = 0; i < invocations; ++i) invoke(order[i], static_cast<int>(i & 7));
+        }) * 1e6 / static_cast<double>(invocations);
+    };
+
+    const double raw_ns = run([&](std::uint32_t o, int x) { raw[o]->process(x); });
+    const double weak_ns = run([&](std::uint32_t o, int x) {
+        if (auto sp = weak[o].lock()) sp->process(x);
+    });
+    const double slot_ns = run([&](std::uint32_t o, int x) {
+        if (Foo* foo = foos.get(handles[o])) foo->process(x);
+    });
+
+    // 10% of the objects go away: stale handles and expired weak_ptrs must be skipped
+    for (std::size_t i = 0; i < objects; i += 10) {
+        shared[i].reset();
+        foos.erase(handles[i]);
+    }
+    const double weak_stale_ns = run([&](std::uint32_t o, int x) {
+        if (auto sp = weak[o].lock()) sp->process(x);
+    });
+    const double slot_stale_ns = run([&](std::uint32_t o, int x) {
+        if (Foo* foo = foos.get(handles[o])) foo->process(x);
+    });
+
+    long long weak_total = 0, slot_total = 0;
+    for (auto& sp : shared)
+        if (sp) weak_total += sp->total();
+    foos.for_each([&](const Foo& foo) { slot_total += foo.total(); });
+
+    std::cout << "  " << invocations << " callbacks over " << objects << " objects in random order (ns per call, best of 5)\n\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << std::left << std::setw(40) << "[&foo] raw pointer (unsafe)" << std::right << std::setw(8) << raw_ns << '\n';
+    std::cout << "  " << std::left << std::setw(40) << "weak_ptr::lock() per call" << std::right << std::setw(8) << weak_ns
+              << std::setw(10) << weak_ns / slot_ns << "x slot map\n";
+    std::cout << "  " << std::left << std::setw(40) << "slot map handle" << std::right << std::setw(8) << slot_ns << '\n';
+    std::cout << "  " << std::left << std::setw(40) << "weak_ptr::lock(), 10% expired" << std::right << std::setw(8) << weak_stale_ns << '\n';
+    std::cout << "  " << std::left << std::setw(40) << "slot map handle, 10% stale" << std::right << std::setw(8) << slot_stale_ns << '\n';
+    std::cout << "\n  Totals of the surviving objects match: " << (weak_total == slot_total ? "OK" : "MISMATCH") << '\n';
+    std::cout << "  sizeof: weak_ptr " << sizeof(std::weak_ptr<Foo>) << " bytes, slot::Handle " << sizeof(slot::Handle) << " bytes\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t invocations = 10000000;
+    if (argc > 1) invocations = std::strtoull(argv[1], nullptr, 10);
+
+    std::cout << "Generation-Checked Slot-Map Handles\n";
+    std::cout << "===================================\n";
+
+    demonstrate_handles();
+    benchmark_invocation(invocations);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ A stale handle is detected by one load + compare, with no atomics\n";
+    std::cout << "  ✅ Handles are 8 bytes and trivially copyable: cheap to capture and store\n";
+    std::cout << "  ✅ Slot reuse cannot resurrect old handles: the generation moved on\n";
+    std::cout << "  ⚠️ The map must outlive the callbacks that capture it, and it is single-threaded\n";
+    return 0;
+}
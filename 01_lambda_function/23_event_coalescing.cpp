@@ -0,0 +1,289 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <new>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+/**
+ * 23_event_coalescing.cpp
+ *
+ * PURPOSE: Stop running handlers for updates that are already superseded.
+ * When one key is updated 50 times between two handler runs, only the last
+ * value (or the merged total) matters.
+ *
+ *   source.on_update([&foo](std::uint32_t key, std::uint64_t v) { foo.process(key, v); });
+ *       // one handler call per event
+ *
+ *   coalesce::Dispatcher<coalesce::LastWins> pending(keys);
+ *   source.on_update([&pending](std::uint32_t key, std::uint64_t v) { pending.post(key, v); });
+ *   every window: pending.drain([&foo](std::uint32_t key, std::uint64_t v) { foo.process(key, v); });
+ *       // one handler call per key that changed in the window
+ *
+ * Every key owns a slot {value, pending flag}; there are no locks.
+ *
+ *   post(key, v):  merge v into the slot (LastWins: store, Accumulate: fetch_add);
+ *                  if the pending flag was clear, set it and push the key onto a
+ *                  ready ring (one fetch_add). Repeats of a pending key touch
+ *                  only their slot.
+ *   drain(fn):     single consumer. For each ready key: clear the flag, THEN take
+ *                  the value, then call fn. A post racing with the drain either
+ *                  lands before the take or sees the cleared flag and queues the
+ *                  key again, so no update is lost.
+ *
+ * A key is on the ring at most once, so a ring of 2 * keys cells never fills.
+ *
+ * Build: g++ -std=c++14 -O2 -pthread 23_event_coalescing.cpp -o 23_event_coalescing_cpp14
+ * Run:   ./23_event_coalescing_cpp14 [seconds] [keys]
+ */
+
+namespace coalesce {
+
+// Merge policies: how a new value meets the one still waiting in the slot.
+// seq_cst on the value and the pending flag: post writes value then reads the
+// flag, drain writes the flag then reads the value.
+struct LastWins {
+    static void merge(std::atomic<std::uint64_t>& slot, std::uint64_t v) { slot.store(v); }
+    static std::uint64_t take(std::atomic<std::uint64_t>& slot) { return slot.load(); }
+};
+
+struct Accumulate {
+    static void merge(std::atomic<std::uint64_t>& slot, std::uint64_t v) { slot.fetch_add(v); }
+    static std::uint64_t take(std::atomic<std::uint64_t>& slot) { return slot.exchange(0); }
+};
+
+template <typename Policy>
+class Dispatcher {
+public:
+    explicit Dispatcher(std::uint32_t keys)
+        : storage_(new unsigned char[keys * sizeof(Slot) + alignof(Slot)]),
+          ring_mask_(ring_size(keys) - 1),
+          ring_(new std::atomic<std::uint32_t>[ring_mask_ + 1]) {
+        // new Slot[] ignores alignas(64) before C++17: align by hand
+        void* p = storage_.get();
+        std::size_t space = keys * sizeof(Slot) + alignof(Slot);
+        slots_ = static_cast<Slot*>(std::align(alignof(Slot), keys * sizeof(Slot), p, space));
+        for (std::uint32_t i = 0; i < keys; ++i) new (slots_ + i) Slot();
+        for (std::size_t i = 0; i <= ring_mask_; ++i) ring_[i].store(0, std::memory_order_relaxed);
+    }
+
+    // Any thread
+    void post(std::uint32_t key, std::uint64_t value) {
+        Slot& slot = slots_[key];
+        Policy::merge(slot.value, value);
+        if (slot.pending.load() || slot.pending.exchange(true)) return;   // Already queued: coalesced
+        const std::uint64_t i = tail_.fetch_add(1, std::memory_order_relaxed);
+        ring_[i & ring_mask_].store(key + 1, std::memory_order_release);
+    }
+
+    // One consumer thread. Returns the number of handler calls.
+    template <typename F>
+    std::size_t drain(F&& handler) {
+        const std::uint64_t end = tail_.load(std::memory_order_acquire);
+        std::size_t calls = 0;
+        for (; head_ < end; ++head_) {
+            std::atomic<std::uint32_t>& cell = ring_[head_ & ring_mask_];
+            std::uint32_t entry;
+            while ((entry = cell.load(std::memory_order_acquire)) == 0) std::this_thread::yield();   // Claimed, not yet written
+            cell.store(0, std::memory_order_relaxed);
+            Slot& slot = slots_[entry - 1];
+            slot.pending.store(false);
+            handler(entry - 1, Policy::take(slot.value));
+            ++calls;
+        }
+        return calls;
+    }
+
+private:
+    struct alignas(64) Slot {   // One per cache line: hot keys written by different producers do not false-share
+        std::atomic<std::uint64_t> value{0};
+        std::atomic<bool> pending{false};
+    };
+
+    static std::size_t ring_size(std::uint32_t keys) {
+        std::size_t n = 1;
+        while (n < 2 * std::size_t{keys}) n <<= 1;
+        return n;
+    }
+
+    std::unique_ptr<unsigned char[]> storage_;   // Slots are trivially destructible
+    Slot* slots_;
+    std::size_t ring_mask_;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> ring_;
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    alignas(64) std::uint64_t head_ = 0;   // Consumer only
+};
+
+}  // namespace coalesce
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+double process_cpu_ms() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e3 + static_cast<double>(ts.tv_nsec) * 1e-6;
+}
+
+// Foo from 04_lambda_replace_bind.cpp: a handler that does real work per call
+class Foo {
+public:
+    explicit Foo(std::uint32_t keys) : last_(keys, 0) {}
+
+    void process(std::uint32_t key, std::uint64_t value) {
+        // Stand-in for re-rendering / recomputing from the new value: ~0.3 us
+        double x = static_cast<double>(value);
+        for (int i = 0; i < 100; ++i) x = std::sqrt(x + i);
+        sink_ = sink_ + x;
+        last_[key] = value;
+        ++calls_;
+    }
+
+    const std::vector<std::uint64_t>& last() const { return last_; }
+    std::size_t calls() const { return calls_; }
+
+private:
+    std::vector<std::uint64_t> last_;
+    std::size_t calls_ = 0;
+    volatile double sink_ = 0;
+};
+
+void demonstrate_coalescing() {
+    section_header("Ten updates, two keys, one drain");
+    const char* names[] = {"temperature", "humidity"};
+    coalesce::Dispatcher<coalesce::LastWins> latest(2);
+    coalesce::Dispatcher<coalesce::Accumulate> deltas(2);
+    for (std::uint64_t i = 1; i <= 10; ++i) {
+        latest.post(i % 3 == 0, 200 + i);   // Mostly temperature
+        deltas.post(i % 3 == 0, i);
+    }
+    std::cout << "  LastWins:\n";
+    latest.drain([&](std::uint32_t key, std::uint64_t v) { std::cout << "    " << names[key] << " = " << v << '\n'; });
+    std::cout << "  Accumulate:\n";
+    deltas.drain([&](std::uint32_t key, std::uint64_t v) { std::cout << "    " << names[key] << " += " << v << '\n'; });
+    std::cout << "  Ten posts became two handler calls per dispatcher\n";
+}
+
+// Zipf(1) over the keys: a few hot keys get most of the updates
+std::vector<std::uint32_t> make_keys(std::size_t events, std::uint32_t keys) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (std::uint32_t k = 0; k < keys; ++k) cdf[k] = sum += 1.0 / (k + 1);
+    std::mt19937_64 rng(96);
+    std::uniform_real_distribution<double> u(0, sum);
+    std::vector<std::uint32_t> out(events);
+    for (auto& k : out)
+        k = static_cast<std::uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin());
+    return out;
+}
+
+struct RunResult {
+    std::size_t calls;
+    double cpu_ms;
+    double wall_ms;
+    bool ok;
+};
+
+// Posts events[i] = (keys[i], i + 1) at `rate` per second, in 100 us bursts
+template <typename Post>
+double paced_producer(const std::vector<std::uint32_t>& keys, double rate, Post&& post) {
+    const std::size_t burst = std::max<std::size_t>(1, static_cast<std::size_t>(rate * 1e-4));
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < keys.size(); i += burst) {
+        std::this_thread::sleep_until(start + std::chrono::microseconds(100 * (i / burst)));
+        for (std::size_t j = i; j < std::min(keys.size(), i + burst); ++j) post(keys[j], j + 1);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+RunResult run_direct(const std::vector<std::uint32_t>& keys, std::uint32_t key_count, double rate,
+                     const std::vector<std::uint64_t>& expected_last) {
+    Foo foo(key_count);
+    const double cpu0 = process_cpu_ms();
+    const double wall = paced_producer(keys, rate, [&](std::uint32_t key, std::uint64_t v) { foo.process(key, v); });
+    return {foo.calls(), process_cpu_ms() - cpu0, wall, foo.last() == expected_last};
+}
+
+RunResult run_coalesced(const std::vector<std::uint32_t>& keys, std::uint32_t key_count, double rate,
+                        std::chrono::microseconds window, const std::vector<std::uint64_t>& expected_last) {
+    Foo foo(key_count);
+    coalesce::Dispatcher<coalesce::LastWins> pending(key_count);
+    std::atomic<bool> done{false};
+    const double cpu0 = process_cpu_ms();
+    std::thread consumer([&] {
+        auto next = std::chrono::steady_clock::now();
+        while (!done.load(std::memory_order_acquire)) {
+            next += window;
+            std::this_thread::sleep_until(next);
+            pending.drain([&](std::uint32_t key, std::uint64_t v) { foo.process(key, v); });
+        }
+        pending.drain([&](std::uint32_t key, std::uint64_t v) { foo.process(key, v); });   // What is left
+    });
+    const double wall = paced_producer(keys, rate, [&](std::uint32_t key, std::uint64_t v) { pending.post(key, v); });
+    done.store(true, std::memory_order_release);
+    consumer.join();
+    return {foo.calls(), process_cpu_ms() - cpu0, wall, foo.last() == expected_last};
+}
+
+void benchmark_coalescing(double seconds, std::uint32_t key_count) {
+    section_header("BENCHMARK: handler calls and CPU at 1M events/sec");
+    const double rate = 1e6;
+    const std::size_t events = static_cast<std::size_t>(rate * seconds);
+    const std::vector<std::uint32_t> keys = make_keys(events, key_count);
+    std::vector<std::uint64_t> expected_last(key_count, 0);
+    for (std::size_t i = 0; i < events; ++i) expected_last[keys[i]] = i + 1;
+    const std::size_t touched = static_cast<std::size_t>(
+        std::count_if(expected_last.begin(), expected_last.end(), [](std::uint64_t v) { return v != 0; }));
+
+    std::cout << "  " << events << " updates over " << seconds << " s, Zipf(1) over " << key_count << " keys ("
+              << touched << " touched); handler ~0.3 us\n\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(26) << "delivery" << std::right << std::setw(12) << "calls" << std::setw(10)
+              << "saved" << std::setw(12) << "CPU ms" << std::setw(12) << "wall ms" << std::setw(12) << "last value"
+              << '\n';
+    auto row = [&](const std::string& name, const RunResult& r) {
+        std::cout << "  " << std::left << std::setw(26) << name << std::right << std::setw(12) << r.calls << std::setw(9)
+                  << 100.0 * (1.0 - static_cast<double>(r.calls) / static_cast<double>(events)) << "%" << std::setw(12)
+                  << r.cpu_ms << std::setw(12) << r.wall_ms << std::setw(12) << (r.ok ? "OK" : "MISMATCH") << '\n';
+    };
+    row("every event", run_direct(keys, key_count, rate, expected_last));
+    row("coalesced, 100 us window", run_coalesced(keys, key_count, rate, std::chrono::microseconds(100), expected_last));
+    row("coalesced, 1 ms window", run_coalesced(keys, key_count, rate, std::chrono::microseconds(1000), expected_last));
+    row("coalesced, 10 ms window", run_coalesced(keys, key_count, rate, std::chrono::microseconds(10000), expected_last));
+    std::cout << "  CPU is the whole process: producer pacing + posting + handlers. wall > "
+              << std::setprecision(0) << seconds * 1e3 << " ms means the handlers could not keep up.\n";
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = 1.0;
+    std::uint32_t keys = 1000;
+    if (argc > 1) seconds = std::strtod(argv[1], nullptr);
+    if (argc > 2) keys = static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10));
+    if (keys == 0) {
+        std::cerr << "keys must be at least 1\n";
+        return 1;
+    }
+
+    std::cout << "Callback Coalescing and Debouncing\n";
+    std::cout << "==================================\n";
+
+    demonstrate_coalescing();
+    benchmark_coalescing(seconds, keys);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ A repeated update for a pending key costs one atomic store and one load\n";
+    std::cout << "  ✅ Handler calls drop from one per event to one per changed key per window\n";
+    std::cout << "  ✅ Clearing the flag before taking the value means no update is ever lost\n";
+    std::cout << "  ⚠️ The window is added latency: pick it from how stale a handler may be\n";
+    return 0;
+}
@@ -0,0 +1,538 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <memory>
+#include <new>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <sstream>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * 24_small_vector.cpp
+ *
+ * PURPOSE: Keep short move-captured vectors out of the heap.
+ *
+ *   auto lambda_with_move = [v = std::move(data)](int m) { ... };   // from 04
+ *
+ * With std::vector<int> data that is one heap block for the elements, and
+ * std::function adds a second one because the closure (24 B) is larger than
+ * its 16 B local buffer. For per-request vectors of a handful of elements the
+ * two allocations cost more than the work.
+ *
+ *   sv::small_vector<T, N>     the std::vector API with room for N elements
+ *                              inline; spills to the heap only past N
+ *   sv::inplace_function<R(Args...), Capacity>
+ *                              a std::function that stores the closure in a
+ *                              Capacity-byte member and refuses (at compile
+ *                              time) closures that do not fit
+ *
+ *   sv::small_vector<int, 16> data = ...;
+ *   sv::inplace_function<int(int), 96> fn = [v = std::move(data)](int m) { ... };
+ *                                        // <= 16 elements: no allocation at all
+ *
+ * Moving an inline small_vector moves its elements one by one (a heap one
+ * still just steals the pointer), so keep N to what fits in a cache line or two.
+ *
+ * Build: g++ -std=c++14 -O2 24_small_vector.cpp -o 24_small_vector_cpp14
+ * Run:   ./24_small_vector_cpp14 [closures]
+ */
+
+namespace sv {
+
+template <typename T, std::size_t N>
+class small_vector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type inline_capacity = N;
+
+    small_vector() noexcept : data_(inline_data()) {}
+    explicit small_vector(size_type n) : small_vector() { resize(n); }
+    small_vector(size_type n, const T& value) : small_vector() { assign(n, value); }
+    template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    small_vector(It first, It last) : small_vector() { assign(first, last); }
+    small_vector(std::initializer_list<T> init) : small_vector() { assign(init.begin(), init.end()); }
+
+    small_vector(const small_vector& other) : small_vector() { assign(other.begin(), other.end()); }
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : small_vector() {
+        take(std::move(other));
+    }
+
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            clear();
+            release_heap();
+            take(std::move(other));
+        }
+        return *this;
+    }
+    small_vector& operator=(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    ~small_vector() {
+        clear();
+        release_heap();
+    }
+
+    void assign(size_type n, const T& value) {
+        clear();
+        reserve(n);
+        for (size_type i = 0; i < n; ++i) new (data_ + i) T(value);
+        size_ = n;
+    }
+    template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    void assign(It first, It last) {
+        clear();
+        for (; first != last; ++first) emplace_back(*first);
+    }
+    void assign(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+
+    // Element access
+    reference at(size_type i) {
+        if (i >= size_) throw std::out_of_range("sv::small_vector::at");
+        return data_[i];
+    }
+    const_reference at(size_type i) const {
+        if (i >= size_) throw std::out_of_range("sv::small_vector::at");
+        return data_[i];
+    }
+    reference operator[](size_type i) { return data_[i]; }
+    const_reference operator[](size_type i) const { return data_[i]; }
+    reference front() { return data_[0]; }
+    const_reference front() const { return data_[0]; }
+    reference back() { return data_[size_ - 1]; }
+    const_reference back() const { return data_[size_ - 1]; }
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    // Iterators
+    iterator begin() noexcept { return data_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator cbegin() const noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+    const_iterator cend() const noexcept { return data_ + size_; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // Capacity
+    bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    size_type max_size() const noexcept { return static_cast<size_type>(-1) / sizeof(T); }
+    size_type capacity() const noexcept { return capacity_; }
+    bool is_inline() const noexcept { return data_ == inline_data(); }
+
+    void reserve(size_type n) {
+        if (n > capacity_) reallocate(n);
+    }
+    void shrink_to_fit() {
+        if (!is_inline() && size_ < capacity_) reallocate(size_);
+    }
+
+    // Modifiers
+    void clear() noexcept {
+        destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // Construct the new element before moving the old ones: args may alias an element
+            const size_type new_capacity = grown(size_ + 1);
+            T* fresh = allocate(new_capacity);
+            new (fresh + size_) T(std::forward<Args>(args)...);
+            adopt(fresh, new_capacity);
+        } else {
+            new (data_ + size_) T(std::forward<Args>(args)...);
+        }
+        return data_[size_++];
+    }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void pop_back() { data_[--size_].~T(); }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        const size_type at = static_cast<size_type>(pos - begin());
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + at, end() - 1, end());
+        return begin() + at;
+    }
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+    iterator insert(const_iterator pos, size_type n, const T& value) {
+        const size_type at = static_cast<size_type>(pos - begin());
+        const size_type old_size = size_;
+        const T copy = value;   // value may live inside this vector
+        reserve(size_ + n);
+        for (size_type i = 0; i < n; ++i) emplace_back(copy);
+        std::rotate(begin() + at, begin() + old_size, end());
+        return begin() + at;
+    }
+    template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    iterator insert(const_iterator pos, It first, It last) {
+        const size_type at = static_cast<size_type>(pos - begin());
+        const size_type old_size = size_;
+        for (; first != last; ++first) emplace_back(*first);
+        std::rotate(begin() + at, begin() + old_size, end());
+        return begin() + at;
+    }
+    iterator insert(const_iterator pos, std::initializer_list<T> init) { return insert(pos, init.begin(), init.end()); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+    iterator erase(const_iterator first, const_iterator last) {
+        iterator out = begin() + (first - begin());
+        iterator tail = std::move(begin() + (last - begin()), end(), out);
+        destroy(tail, end());
+        size_ = static_cast<size_type>(tail - begin());
+        return out;
+    }
+
+    void resize(size_type n) {
+        if (n < size_) return erase(begin() + n, end()), void();
+        reserve(n);
+        for (; size_ < n; ++size_) new (data_ + size_) T();
+    }
+    void resize(size_type n, const T& value) {
+        if (n < size_) return erase(begin() + n, end()), void();
+        if (n > capacity_) {
+            const T copy = value;   // value may live inside this vector
+            reserve(n);
+            for (; size_ < n; ++size_) new (data_ + size_) T(copy);
+            return;
+        }
+        for (; size_ < n; ++size_) new (data_ + size_) T(value);
+    }
+
+    void swap(small_vector& other) {
+        small_vector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    T* inline_data() noexcept { return reinterpret_cast<T*>(inline_); }
+    const T* inline_data() const noexcept { return reinterpret_cast<const T*>(inline_); }
+
+    static T* allocate(size_type n) { return static_cast<T*>(::operator new(n * sizeof(T))); }
+    static void destroy(T* first, T* last) noexcept {
+        for (; first != last; ++first) first->~T();
+    }
+
+    size_type grown(size_type needed) const { return std::max(needed, 2 * capacity_); }
+
+    // Move the elements into `fresh` and make it the storage
+    void adopt(T* fresh, size_type new_capacity) {
+        for (size_type i = 0; i < size_; ++i) new (fresh + i) T(std::move_if_noexcept(data_[i]));
+        destroy(data_, data_ + size_);
+        release_heap();
+        data_ = fresh;
+        capacity_ = new_capacity;
+    }
+
+    void reallocate(size_type new_capacity) {
+        if (new_capacity <= N) {   // shrink_to_fit back into the inline buffer
+            if (is_inline()) return;
+            T* heap = data_;
+            for (size_type i = 0; i < size_; ++i) new (inline_data() + i) T(std::move_if_noexcept(heap[i]));
+            destroy(heap, heap + size_);
+            ::operator delete(heap);
+            data_ = inline_data();
+            capacity_ = N;
+            return;
+        }
+        adopt(allocate(new_capacity), new_capacity);
+    }
+
+    void release_heap() noexcept {
+        if (!is_inline()) ::operator delete(data_);
+        data_ = inline_data();
+        capacity_ = N;
+    }
+
+    // Steal a heap buffer, or move the inline elements one by one
+    void take(small_vector&& other) {
+        if (other.is_inline()) {
+            for (size_type i = 0; i < other.size_; ++i) new (data_ + i) T(std::move(other.data_[i]));
+            size_ = other.size_;
+            other.clear();
+        } else {
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_data();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+
+    T* data_;
+    size_type size_ = 0;
+    size_type capacity_ = N;
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+};
+
+template <typename T, std::size_t N>
+bool operator==(const small_vector<T, N>& a, const small_vector<T, N>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+template <typename T, std::size_t N>
+bool operator!=(const small_vector<T, N>& a, const small_vector<T, N>& b) {
+    return !(a == b);
+}
+template <typename T, std::size_t N>
+bool operator<(const small_vector<T, N>& a, const small_vector<T, N>& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+template <typename T, std::size_t N>
+bool operator>(const small_vector<T, N>& a, const small_vector<T, N>& b) {
+    return b < a;
+}
+template <typename T, std::size_t N>
+bool operator<=(const small_vector<T, N>& a, const small_vector<T, N>& b) {
+    return !(b < a);
+}
+template <typename T, std::size_t N>
+bool operator>=(const small_vector<T, N>& a, const small_vector<T, N>& b) {
+    return !(a < b);
+}
+template <typename T, std::size_t N>
+void swap(small_vector<T, N>& a, small_vector<T, N>& b) {
+    a.swap(b);
+}
+
+template <typename Signature, std::size_t Capacity>
+class inplace_function;
+
+namespace detail {
+
+template <typename R, typename... Args>
+struct Ops {
+    R (*invoke)(void*, Args&&...);
+    void (*move)(void* dst, void* src);   // Move-construct dst from src, destroy src
+    void (*destroy)(void*);
+};
+
+// A variable template needs no out-of-line definition in C++14
+template <typename Fn, typename R, typename... Args>
+const Ops<R, Args...> kOps = {
+    [](void* f, Args&&... args) -> R { return (*static_cast<Fn*>(f))(std::forward<Args>(args)...); },
+    [](void* dst, void* src) {
+        new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+        static_cast<Fn*>(src)->~Fn();
+    },
+    [](void* f) { static_cast<Fn*>(f)->~Fn(); },
+};
+
+}  // namespace detail
+
+template <typename R, typename... Args, std::size_t Capacity>
+class inplace_function<R(Args...), Capacity> {
+public:
+    inplace_function() noexcept = default;
+
+    template <typename F, typename Fn = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<Fn, inplace_function>::value>::type>
+    inplace_function(F&& f) {
+        static_assert(sizeof(Fn) <= Capacity, "closure does not fit in the inplace_function buffer");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "closure is over-aligned");
+        new (storage_) Fn(std::forward<F>(f));
+        ops_ = &detail::kOps<Fn, R, Args...>;
+    }
+
+    inplace_function(inplace_function&& other) noexcept : ops_(other.ops_) {
+        if (ops_) ops_->move(storage_, other.storage_);
+        other.ops_ = nullptr;
+    }
+    inplace_function& operator=(inplace_function&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops_ = other.ops_;
+            if (ops_) ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+        return *this;
+    }
+    inplace_function(const inplace_function&) = delete;   // Move-only, like the captures it holds
+    inplace_function& operator=(const inplace_function&) = delete;
+
+    ~inplace_function() { reset(); }
+
+    R operator()(Args... args) {
+        if (!ops_) throw std::bad_function_call();
+        return ops_->invoke(storage_, std::forward<Args>(args)...);
+    }
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    void reset() noexcept {
+        if (ops_) ops_->destroy(storage_);
+        ops_ = nullptr;
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    const detail::Ops<R, Args...>* ops_ = nullptr;
+};
+
+}  // namespace sv
+
+// Every allocation in the process goes through here, so the benchmark can count them
+static std::size_t g_allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+void demonstrate_small_vector() {
+    section_header("04's move capture, without the heap");
+    sv::small_vector<int, 16> data = {1, 2, 3, 4, 5};
+    const std::size_t before = g_allocations;
+    sv::inplace_function<int(int), 96> lambda_with_move = [v = std::move(data)](int multiplier) {
+        int sum = 0;
+        for (int x : v) sum += x * multiplier;
+        return sum;
+    };
+    std::cout << "  sum * 2 = " << lambda_with_move(2) << ", moved-from size = " << data.size()
+              << ", heap allocations = " << g_allocations - before << '\n';
+
+    sv::small_vector<int, 4> v = {5, 1, 4};
+    v.insert(v.begin() + 1, 9);
+    v.push_back(7);   // 5 elements: spills past the 4 inline slots
+    v.erase(std::remove(v.begin(), v.end(), 1), v.end());
+    std::sort(v.begin(), v.end());
+    std::cout << "  small_vector<int, 4>:";
+    for (int x : v) std::cout << ' ' << x;
+    std::cout << "  (size " << v.size() << ", capacity " << v.capacity() << ", " << (v.is_inline() ? "inline" : "heap")
+              << ")\n";
+    v.resize(3);
+    v.shrink_to_fit();
+    std::cout << "  after resize(3) + shrink_to_fit: " << (v.is_inline() ? "inline" : "heap") << " again\n";
+
+    std::cout << "  sizeof: std::vector<int> " << sizeof(std::vector<int>) << ", small_vector<int, 16> "
+              << sizeof(sv::small_vector<int, 16>) << ", std::function " << sizeof(std::function<int(int)>)
+              << ", inplace_function<.., 96> " << sizeof(sv::inplace_function<int(int), 96>) << " bytes\n";
+}
+
+struct Result {
+    double ns;
+    double allocations;
+    long long checksum;
+};
+
+// One closure per request: fill the data, move it into a callable, call it, drop it
+template <typename Vector, typename Callable>
+Result run(std::size_t closures, std::size_t elements) {
+    long long checksum = 0;
+    const std::size_t before = g_allocations;
+    const double ms = time_ms([&] {
+        long long sum = 0;
+        for (std::size_t i = 0; i < closures; ++i) {
+            Vector data;
+            for (std::size_t j = 0; j < elements; ++j) data.push_back(static_cast<int>((i + j) & 15));
+            Callable fn = [v = std::move(data)](int multiplier) {
+                int s = 0;
+                for (int x : v) s += x * multiplier;
+                return s;
+            };
+            sum += fn(static_cast<int>(i & 3));
+        }
+        checksum = sum;
+    });
+    const double allocations = static_cast<double>(g_allocations - before) / (5.0 * static_cast<double>(closures));
+    return {ms * 1e6 / static_cast<double>(closures), allocations, checksum};
+}
+
+void benchmark_closures(std::size_t closures) {
+    section_header("BENCHMARK: create + invoke + destroy a move-capturing closure");
+    using Vec = std::vector<int>;
+    using Small = sv::small_vector<int, 16>;
+    using Fn = std::function<int(int)>;
+    using Inplace = sv::inplace_function<int(int), 96>;
+
+    std::cout << "  " << closures << " closures per size; ns per closure (allocations per closure)\n\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(10) << "elements" << std::setw(20) << "vector+function" << std::setw(20) << "vector+inplace"
+              << std::setw(20) << "small16+function" << std::setw(20) << "small16+inplace" << std::setw(10) << "check"
+              << '\n';
+    for (std::size_t elements : {4, 16, 64}) {
+        // Reserve-free push_back for std::vector: what per-request code usually does
+        const Result r[] = {run<Vec, Fn>(closures, elements), run<Vec, Inplace>(closures, elements),
+                            run<Small, Fn>(closures, elements), run<Small, Inplace>(closures, elements)};
+        std::cout << std::setw(10) << elements;
+        bool ok = true;
+        for (const Result& x : r) {
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(1) << x.ns << " (" << std::setprecision(0) << x.allocations << ")";
+            std::cout << std::setw(20) << cell.str();
+            ok = ok && x.checksum == r[0].checksum;
+        }
+        std::cout << std::setw(10) << (ok ? "OK" : "MISMATCH") << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t closures = 1000000;
+    if (argc > 1) closures = std::strtoull(argv[1], nullptr, 10);
+
+    std::cout << "Inline Small-Vector Captures\n";
+    std::cout << "============================\n";
+
+    demonstrate_small_vector();
+    benchmark_closures(closures);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ Up to N elements, small_vector + inplace_function make a closure with zero allocations\n";
+    std::cout << "  ✅ Past N, small_vector spills to the heap and behaves like std::vector\n";
+    std::cout << "  ✅ std::function still allocates for any closure over 16 bytes: the callable matters too\n";
+    std::cout << "  ⚠️ Inline elements are copied on every move: size N for the common case, not the worst\n";
+    return 0;
+}
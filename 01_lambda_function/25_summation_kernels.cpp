@@ -0,0 +1,337 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <random>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * 25_summation_kernels.cpp
+ *
+ * PURPOSE: Reductions over float/double pipelines that are both faster and
+ * more accurate than the accumulate lambda.
+ *
+ *   std::accumulate(x, x + n, T(0), [](T s, T v) { return s + v; });
+ *
+ * is one dependent add per element (latency bound: ~4 cycles each) and its
+ * rounding error grows with n. The compiler may not split it into SIMD lanes
+ * because that reassociates floating-point additions (-ffast-math would).
+ * The kernels below reassociate on purpose, in a fixed order, with L
+ * independent lanes (L = 64 bytes / sizeof(T): 8 doubles, 16 floats) that the
+ * vectorizer maps onto SSE2/AVX registers.
+ *
+ * Error bounds (first order; u = epsilon/2, S = exact sum, A = sum of |x|,
+ * B = elements per block, m = n / L elements per lane):
+ *
+ *   accumulate   |E| <= (n - 1) u A
+ *   pairwise     |E| <= (B/L + log2 L + ceil(log2(n/B))) u A
+ *                  lanes inside 256-element blocks, blocks combined as a tree
+ *   Kahan        |E| <= (2u + 2 m u^2) A + u |S|
+ *                  loses the compensation when |x| > |running sum|
+ *   Neumaier     |E| <= u |S| + 2 m u^2 A
+ *                  each lane keeps the exact rounding error of every add
+ *                  (TwoSum, branch-free so it vectorizes); lanes are merged
+ *                  the same way
+ *
+ * When A ~ |S| (all values one sign) every bound is tiny; the gap opens as the
+ * data cancels (condition number A / |S| grows).
+ *
+ * Speed: pairwise keeps its lanes in registers and runs at load throughput.
+ * Kahan and Neumaier need 4 and 7 flops per element and carry two values per
+ * lane, which the vectorizer keeps in L1 rather than registers; they cost
+ * about what the latency-bound accumulate does while erasing its error.
+ *
+ * Build: g++ -std=c++14 -O2 25_summation_kernels.cpp -o 25_summation_kernels_cpp14
+ * Run:   ./25_summation_kernels_cpp14 [n]
+ */
+
+namespace sum {
+
+template <typename T>
+struct Lanes {
+    static constexpr std::size_t value = 64 / sizeof(T);
+};
+
+constexpr std::size_t kBlock = 256;
+
+template <typename T>
+T accumulate(const T* x, std::size_t n) {
+    return std::accumulate(x, x + n, T(0), [](T s, T v) { return s + v; });
+}
+
+// Tree-reduce the lanes: lane l += lane l + w for w = L/2, L/4, ..., 1
+template <typename T, std::size_t L>
+T reduce_lanes(T (&acc)[L]) {
+    for (std::size_t w = L / 2; w > 0; w /= 2)
+        for (std::size_t l = 0; l < w; ++l) acc[l] += acc[l + w];
+    return acc[0];
+}
+
+template <typename T>
+T block_sum(const T* __restrict x, std::size_t n) {
+    constexpr std::size_t L = Lanes<T>::value;
+    T acc[L] = {};
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {  // must-vectorize
+#pragma GCC unroll 32
+        for (std::size_t l = 0; l < L; ++l) acc[l] += x[i + l];   // Unrolled: the lanes stay in registers
+    }
+    for (std::size_t l = 0; i < n; ++i, ++l) acc[l] += x[i];
+    return reduce_lanes(acc);
+}
+
+template <typename T>
+T pairwise(const T* x, std::size_t n) {
+    if (n <= kBlock) return block_sum(x, n);
+    const std::size_t half = (n / 2 + kBlock - 1) / kBlock * kBlock;   // Split on a block boundary
+    return pairwise(x, half) + pairwise(x + half, n - half);
+}
+
+template <typename T>
+T kahan(const T* __restrict x, std::size_t n) {
+    constexpr std::size_t L = Lanes<T>::value;
+    T s[L] = {}, c[L] = {};
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        for (std::size_t l = 0; l < L; ++l) {  // must-vectorize
+            const T y = x[i + l] - c[l];
+            const T t = s[l] + y;
+            c[l] = (t - s[l]) - y;
+            s[l] = t;
+        }
+    }
+    for (std::size_t l = 0; i < n; ++i, ++l) {
+        const T y = x[i] - c[l];
+        const T t = s[l] + y;
+        c[l] = (t - s[l]) - y;
+        s[l] = t;
+    }
+    T total = 0, comp = 0;
+    for (std::size_t l = 0; l < L; ++l) {
+        const T y = s[l] - c[l] - comp;
+        const T t = total + y;
+        comp = (t - total) - y;
+        total = t;
+    }
+    return total;
+}
+
+// TwoSum: t = fl(a + b) and the exact error e = (a + b) - t, with no branch on |a| vs |b|
+template <typename T>
+inline void two_sum(T a, T b, T& t, T& e) {
+    t = a + b;
+    const T bv = t - a;
+    e = (a - (t - bv)) + (b - bv);
+}
+
+template <typename T>
+T neumaier(const T* __restrict x, std::size_t n) {
+    constexpr std::size_t L = Lanes<T>::value;
+    T s[L] = {}, c[L] = {};
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        for (std::size_t l = 0; l < L; ++l) {  // must-vectorize
+            T t, e;
+            two_sum(s[l], x[i + l], t, e);
+            s[l] = t;
+            c[l] += e;
+        }
+    }
+    for (std::size_t l = 0; i < n; ++i, ++l) {
+        T t, e;
+        two_sum(s[l], x[i], t, e);
+        s[l] = t;
+        c[l] += e;
+    }
+    T total = 0, comp = 0;
+    for (std::size_t l = 0; l < L; ++l) {
+        T t, e;
+        two_sum(total, s[l], t, e);
+        total = t;
+        comp += e + c[l];
+    }
+    return total + comp;
+}
+
+}  // namespace sum
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+// Reference: double-double accumulation, error ~ n u^2 A for doubles
+struct Exact {
+    double hi = 0, lo = 0, abs_sum = 0;
+    void add(double v) {
+        double t, e;
+        sum::two_sum(hi, v, t, e);
+        hi = t;
+        lo += e;
+        abs_sum += std::fabs(v);
+    }
+    double value() const { return hi + lo; }
+};
+
+enum class Kernel { Accumulate, Pairwise, Kahan, Neumaier };
+
+const char* kernel_name(Kernel k) {
+    switch (k) {
+        case Kernel::Accumulate: return "accumulate lambda";
+        case Kernel::Pairwise: return "SIMD pairwise";
+        case Kernel::Kahan: return "SIMD Kahan";
+        case Kernel::Neumaier: return "SIMD Neumaier";
+    }
+    return "";
+}
+
+template <typename T>
+T run(Kernel k, const T* x, std::size_t n) {
+    switch (k) {
+        case Kernel::Accumulate: return sum::accumulate(x, n);
+        case Kernel::Pairwise: return sum::pairwise(x, n);
+        case Kernel::Kahan: return sum::kahan(x, n);
+        case Kernel::Neumaier: return sum::neumaier(x, n);
+    }
+    return 0;
+}
+
+template <typename T>
+double error_bound(Kernel k, std::size_t n, double exact, double abs_sum) {
+    const double u = std::numeric_limits<T>::epsilon() / 2;
+    const double L = static_cast<double>(sum::Lanes<T>::value);
+    const double m = std::ceil(static_cast<double>(n) / L);
+    switch (k) {
+        case Kernel::Accumulate: return static_cast<double>(n - 1) * u * abs_sum;
+        case Kernel::Pairwise: {
+            const double blocks = std::ceil(static_cast<double>(n) / sum::kBlock);
+            return (sum::kBlock / L + std::log2(L) + std::ceil(std::log2(std::max(1.0, blocks)))) * u * abs_sum;
+        }
+        case Kernel::Kahan: return (2 * u + 2 * m * u * u) * abs_sum + u * std::fabs(exact);
+        case Kernel::Neumaier: return u * std::fabs(exact) + 2 * m * u * u * abs_sum;
+    }
+    return 0;
+}
+
+const Kernel kKernels[] = {Kernel::Accumulate, Kernel::Pairwise, Kernel::Kahan, Kernel::Neumaier};
+
+template <typename T>
+void report_accuracy(const std::string& type, const std::string& dataset, const std::vector<double>& source) {
+    const std::vector<T> x(source.begin(), source.end());
+    Exact exact;
+    for (T v : x) exact.add(static_cast<double>(v));
+    const double s = exact.value();
+    std::cout << "  " << type << ", " << dataset << ": n = " << x.size() << ", sum = " << std::setprecision(6)
+              << std::scientific << s << ", condition A/|S| = " << exact.abs_sum / std::fabs(s) << '\n';
+    for (Kernel k : kKernels) {
+        const double got = static_cast<double>(run(k, x.data(), x.size()));
+        const double err = std::fabs(got - s);
+        const double bound = error_bound<T>(k, x.size(), s, exact.abs_sum);
+        std::cout << "    " << std::left << std::setw(22) << kernel_name(k) << std::right << std::setw(14)
+                  << err / std::fabs(s) << std::setw(14) << bound / std::fabs(s) << std::setw(10)
+                  << (err <= bound ? "OK" : "EXCEEDED") << '\n';
+    }
+}
+
+std::vector<double> uniform_data(std::size_t n) {
+    std::mt19937_64 rng(98);
+    std::uniform_real_distribution<double> u(0, 1);
+    std::vector<double> x(n);
+    for (auto& v : x) v = u(rng);
+    return x;
+}
+
+// Half the values are +b/-b pairs with |b| in [scale, 2 scale), the rest in
+// [0, 1), shuffled: the large values cancel exactly, the small ones carry the sum
+std::vector<double> cancelling_data(std::size_t n, double scale) {
+    std::mt19937_64 rng(99);
+    std::uniform_real_distribution<double> u(0, 1);
+    std::vector<double> x(n);
+    for (std::size_t i = 0; i + 1 < n / 2; i += 2) {
+        x[i] = scale * (1 + u(rng));
+        x[i + 1] = -x[i];
+    }
+    for (std::size_t i = n / 2; i < n; ++i) x[i] = u(rng);
+    std::shuffle(x.begin(), x.end(), rng);
+    return x;
+}
+
+void benchmark_accuracy(std::size_t n) {
+    section_header("ACCURACY: relative error vs a double-double reference");
+    std::cout << "    " << std::left << std::setw(22) << "kernel" << std::right << std::setw(14) << "rel. error"
+              << std::setw(14) << "rel. bound" << std::setw(10) << "check" << '\n';
+    // The swamping pairs dwarf the running lane sums, so Kahan's correction is lost
+    const std::vector<double> uniform = uniform_data(n);
+    const std::vector<double> cancelling = cancelling_data(n, 1e3);
+    report_accuracy<float>("float", "uniform [0, 1)", uniform);
+    report_accuracy<float>("float", "cancelling +/-1e3 pairs", cancelling);
+    report_accuracy<float>("float", "swamping +/-1e6 pairs", cancelling_data(n, 1e6));
+    report_accuracy<double>("double", "uniform [0, 1)", uniform);
+    report_accuracy<double>("double", "cancelling +/-1e3 pairs", cancelling);
+    report_accuracy<double>("double", "swamping +/-1e21 pairs", cancelling_data(n, 1e21));
+    std::cout << std::fixed;
+}
+
+template <typename T>
+void report_speed(const std::string& type, std::size_t total) {
+    const std::size_t n = 16384;   // L2-resident: the kernels, not DRAM, set the pace
+    const std::vector<double> source = uniform_data(n);
+    const std::vector<T> x(source.begin(), source.end());
+    const std::size_t repeats = std::max<std::size_t>(1, total / n);
+    double base_ms = 0;
+    for (Kernel k : kKernels) {
+        volatile T sink = 0;
+        const double ms = time_ms([&] {
+            for (std::size_t r = 0; r < repeats; ++r) sink = sink + run(k, x.data(), n);
+        });
+        if (k == Kernel::Accumulate) base_ms = ms;
+        const double gbps = static_cast<double>(repeats * n * sizeof(T)) / (ms * 1e6);
+        std::cout << "  " << std::left << std::setw(8) << type << std::setw(22) << kernel_name(k) << std::right
+                  << std::setw(10) << ms * 1e6 / static_cast<double>(repeats * n) << std::setw(10) << gbps
+                  << std::setw(10) << base_ms / ms << "x\n";
+    }
+}
+
+void benchmark_speed() {
+    section_header("BENCHMARK: speed (16K elements, L2-resident, best of 5)");
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  " << std::left << std::setw(8) << "type" << std::setw(22) << "kernel" << std::right << std::setw(10)
+              << "ns/elem" << std::setw(10) << "GB/s" << std::setw(11) << "speedup" << '\n';
+    report_speed<float>("float", std::size_t{1} << 27);
+    report_speed<double>("double", std::size_t{1} << 27);
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t n = std::size_t{1} << 24;
+    if (argc > 1) n = std::strtoull(argv[1], nullptr, 10);
+
+    std::cout << "Compensated and Pairwise Summation Kernels\n";
+    std::cout << "==========================================\n";
+
+    benchmark_accuracy(n);
+    benchmark_speed();
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ Explicit lanes give the vectorizer a reassociation it may legally use\n";
+    std::cout << "  ✅ Pairwise is the fast default: error grows with log n instead of n\n";
+    std::cout << "  ✅ Neumaier stays accurate on cancelling data, where plain Kahan degrades\n";
+    std::cout << "  ⚠️ Results depend on the lane count: same data, different L, different last bits\n";
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 27_prefetch_gather.cpp
+ *
+ * PURPOSE: A gather stage for transformers that look up a side table:
+ *
+ *   std::transform(keys.begin(), keys.end(), out, [&table](int x) { return table[x]; });
+ *
+ * Once the table outgrows the caches every element is a cache (and TLB) miss.
+ * The loads are independent, but the out-of-order window only overlaps the
+ * few misses that fit in it alongside the rest of the loop body.
+ * gather::transform splits the lambda into its two halves and runs the
+ * index half ahead of the value half:
+ *
+ *   gather::transform(keys.begin(), keys.end(), out, table,
+ *                     [](int x) { return x; },             // index_of
+ *                     [](int v) { return v; },             // value
+ *                     {distance, batch});
+ *
+ * Every step computes the indices of the next `batch` elements that are
+ * `distance` elements ahead, prefetches their table entries into a ring, then
+ * applies `value` to `batch` entries prefetched earlier. distance = 0 is the
+ * plain batch scheme of 10_hash_join.cpp / 13_blocked_bloom.cpp (prefetch a
+ * batch, then read it); a larger distance gives each miss more time to land.
+ * With -march=native, gather::transform_avx2 reads the prefetched int entries
+ * eight at a time with _mm256_i32gather_epi32.
+ *
+ * The benchmark sweeps tables from 1 MB to 4 GB (capped at a quarter of RAM).
+ *
+ * Build: g++ -std=c++14 -O2 27_prefetch_gather.cpp -o 27_prefetch_gather_cpp14
+ *        g++ -std=c++14 -O2 -march=native 27_prefetch_gather.cpp -o 27_prefetch_gather_avx2
+ * Run:   ./27_prefetch_gather_cpp14 [max_table_mb]
+ */
+
+namespace gather {
+
+struct Options {
+    std::size_t distance = 64;   // Elements between prefetching an entry and reading it
+    std::size_t batch = 16;      // Indices computed and prefetched per step
+};
+
+// Ring of computed indices; distance + batch are clamped to fit it
+constexpr std::size_t kRing = 1024;
+
+template <typename RandomIt, typename OutputIt, typename T, typename IndexFn, typename ValueFn>
+OutputIt transform(RandomIt first, RandomIt last, OutputIt out, const T* table, IndexFn index_of, ValueFn value,
+                   Options options = Options()) {
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t batch = std::max<std::size_t>(1, std::min(options.batch, kRing / 2));
+    const std::size_t distance = std::min(options.distance, kRing - batch);
+    std::size_t ring[kRing];
+    std::size_t issued = 0;   // Elements whose index is computed and prefetched
+    for (std::size_t start = 0; start < n; start += batch) {
+        const std::size_t stop = std::min(start + batch, n);
+        for (const std::size_t ahead = std::min(stop + distance, n); issued < ahead; ++issued) {
+            const std::size_t index = static_cast<std::size_t>(index_of(first[issued]));
+            ring[issued % kRing] = index;
+            __builtin_prefetch(table + index);
+        }
+        for (std::size_t i = start; i < stop; ++i) *out++ = value(table[ring[i % kRing]]);
+    }
+    return out;
+}
+
+#if defined(__AVX2__)
+// Same ring, but entries are read eight at a time by one gather instruction.
+// int32 indices: tables of up to 2^31 entries
+template <typename RandomIt, typename OutputIt, typename IndexFn, typename ValueFn>
+OutputIt transform_avx2(RandomIt first, RandomIt last, OutputIt out, const int* table, IndexFn index_of, ValueFn value,
+                        Options options = Options()) {
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t batch = std::max<std::size_t>(8, std::min(options.batch, kRing / 2) / 8 * 8);
+    const std::size_t distance = std::min(options.distance, kRing - batch);
+    alignas(32) std::int32_t ring[kRing];
+    alignas(32) int lanes[8];
+    std::size_t issued = 0;
+    for (std::size_t start = 0; start < n; start += batch) {
+        const std::size_t stop = std::min(start + batch, n);
+        for (const std::size_t ahead = std::min(stop + distance, n); issued < ahead; ++issued) {
+            const std::int32_t index = static_cast<std::int32_t>(index_of(first[issued]));
+            ring[issued % kRing] = index;
+            __builtin_prefetch(table + index);
+        }
+        std::size_t i = start;
+        for (; i + 8 <= stop; i += 8) {   // start is a multiple of 8, so the 8 ring cells are contiguous
+            const __m256i indices = _mm256_load_si256(reinterpret_cast<const __m256i*>(ring + i % kRing));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_i32gather_epi32(table, indices, 4));
+            for (int lane = 0; lane < 8; ++lane) *out++ = value(lanes[lane]);
+        }
+        for (; i < stop; ++i) *out++ = value(table[ring[i % kRing]]);
+    }
+    return out;
+}
+#endif
+
+}  // namespace gather
+
+void section_header(const std::string& title) {
+    std::cout << "\n=== " << title << " ===\n";
+}
+
+template <typename F>
+double time_ms(F&& fn, int repetitions = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best;
+}
+
+std::string human_bytes(std::size_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB"};
+    int unit = 0;
+    while (bytes >= 1024 && unit < 3 && bytes % 1024 == 0) {
+        bytes /= 1024;
+        ++unit;
+    }
+    return std::to_string(bytes) + " " + units[unit];
+}
+
+void demonstrate_gather() {
+    section_header("Same result as std::transform with a table lambda");
+    const std::vector<int> table = {100, 101, 102, 103, 104, 105, 106, 107};
+    const std::vector<int> keys = {7, 0, 3, 3, 5, 1, 6, 2, 4, 7};
+
+    std::vector<int> expected(keys.size()), got(keys.size());
+    std::transform(keys.begin(), keys.end(), expected.begin(), [&table](int x) { return table[x] * 2; });
+    gather::transform(keys.begin(), keys.end(), got.begin(), table.data(), [](int x) { return x; },
+                      [](int v) { return v * 2; }, {4, 3});
+
+    std::cout << "  keys:  ";
+    for (int k : keys) std::cout << std::setw(4) << k;
+    std::cout << "\n  out:   ";
+    for (int v : got) std::cout << std::setw(4) << v;
+    std::cout << "\n  " << (got == expected ? "OK" : "MISMATCH") << " (distance 4, batch 3: the last batch is partial)\n";
+#if defined(__AVX2__)
+    std::cout << "  AVX2: transform_avx2 available (8 x int32 gathers)\n";
+#else
+    std::cout << "  AVX2: not compiled (rebuild with -march=native for transform_avx2)\n";
+#endif
+}
+
+struct Variant {
+    std::string name;
+    gather::Options options;
+    bool avx2;
+};
+
+void benchmark_sweep(std::size_t max_bytes) {
+    const std::size_t phys = static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    if (phys > 0 && max_bytes > phys / 4) {
+        std::size_t capped = std::size_t{1} << 20;
+        while (capped * 4 <= phys / 4) capped *= 4;
+        std::cout << "\n  Largest table capped at " << human_bytes(capped) << " (a quarter of " << (phys >> 20) << " MB RAM)\n";
+        max_bytes = capped;
+    }
+
+    const std::size_t max_entries = max_bytes / sizeof(int);
+    std::unique_ptr<int[]> table(new int[max_entries]);
+    for (std::size_t i = 0; i < max_entries; ++i) table[i] = static_cast<int>((i * 2654435761u) & 0xFFFF);
+
+    constexpr std::size_t kLookups = std::size_t{1} << 21;
+    std::vector<std::uint32_t> keys(kLookups);
+    std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (auto& k : keys) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        k = static_cast<std::uint32_t>(state >> 32);
+    }
+    std::vector<int> out(kLookups);
+
+    std::vector<Variant> variants = {
+        {"prefetch d=0", {0, 16}, false},
+        {"prefetch d=16", {16, 16}, false},
+        {"prefetch d=64", {64, 16}, false},
+        {"prefetch d=256", {256, 16}, false},
+    };
+#if defined(__AVX2__)
+    variants.push_back({"avx2 gather d=64", {64, 16}, true});
+#endif
+
+    section_header("BENCHMARK: ns per lookup, " + std::to_string(kLookups) + " random keys, batch 16");
+    std::cout << "  " << std::left << std::setw(10) << "table" << std::right << std::setw(16) << "std::transform";
+    for (const auto& v : variants) std::cout << std::setw(18) << v.name;
+    std::cout << std::setw(10) << "best" << '\n';
+
+    const auto value = [](int v) { return v * 3 + 1; };
+    for (std::size_t bytes = std::size_t{1} << 20; bytes <= max_bytes; bytes *= 4) {
+        const std::uint32_t mask = static_cast<std::uint32_t>(bytes / sizeof(int) - 1);
+        const auto index_of = [mask](std::uint32_t key) { return key & mask; };
+        const int* data = table.get();
+        const int repetitions = bytes <= (std::size_t{64} << 20) ? 3 : 2;
+
+        const double base_ms = time_ms([&] {
+            std::transform(keys.begin(), keys.end(), out.begin(),
+                           [data, index_of, value](std::uint32_t key) { return value(data[index_of(key)]); });
+        }, repetitions);
+        const long long reference = std::accumulate(out.begin(), out.end(), 0LL);
+        std::cout << "  " << std::left << std::setw(10) << human_bytes(bytes) << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(16) << base_ms * 1e6 / kLookups;
+
+        double best_ms = base_ms;
+        bool agree = true;
+        for (const auto& v : variants) {
+            const double ms = time_ms([&] {
+#if defined(__AVX2__)
+                if (v.avx2) {
+                    gather::transform_avx2(keys.begin(), keys.end(), out.begin(), data, index_of, value, v.options);
+                    return;
+                }
+#endif
+                gather::transform(keys.begin(), keys.end(), out.begin(), data, index_of, value, v.options);
+            }, repetitions);
+            agree = agree && std::accumulate(out.begin(), out.end(), 0LL) == reference;
+            best_ms = std::min(best_ms, ms);
+            std::cout << std::setw(18) << ms * 1e6 / kLookups;
+        }
+        std::cout << std::setw(9) << std::setprecision(1) << base_ms / best_ms << "x" << (agree ? "" : "  MISMATCH") << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_bytes = std::size_t{4} << 30;
+    if (argc > 1) max_bytes = static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) << 20;
+
+    std::cout << "Software-Prefetching Gather Stage\n";
+    std::cout << "=================================\n";
+
+    demonstrate_gather();
+    benchmark_sweep(max_bytes);
+
+    std::cout << "\nKey takeaways:\n";
+    std::cout << "  ✅ Splitting a table lambda into index_of + value lets the stage prefetch ahead of the reads\n";
+    std::cout << "  ✅ Gains appear once the table leaves the caches: more misses in flight than the OoO window holds\n";
+    std::cout << "  ✅ distance is a tunable: too short and misses are still in flight, too long and lines are evicted\n";
+    std::cout << "  ⚠️ In-cache tables gain nothing; the extra index pass can even cost a little there\n";
+    std::cout << "  ⚠️ The hardware already overlaps independent misses: expect tens of percent, not multiples\n";
+    std::cout << "  ⚠️ AVX2 gathers issue one load per lane: they save instructions, not memory latency\n";
+    return 0;
+}
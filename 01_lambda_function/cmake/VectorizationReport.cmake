@@ -0,0 +1,252 @@
+# VectorizationReport.cmake
+#
+# Compiles every demo source once per C++ standard with the compiler's
+# vectorizer remarks enabled and turns them into a per-loop table:
+#
+#   Source | C++ | Loop (file:line) | Vectorized | Width | Reason missed
+#
+# Loops tagged with a `// must-vectorize` comment on their `for` line are
+# checked: the script fails if any of them is reported as not vectorized, or
+# if a marked line that is compiled produces no remark at all (the marker was
+# moved off its loop, or the compiler removed or fully unrolled the loop).
+# Markers inside inactive #if branches are listed but do not fail.
+#
+# Invoked by the `vectorization-report` target:
+#   cmake -DCXX=... -DCXX_ID=GNU|Clang -DSOURCE_DIR=... -DSOURCES=a.cpp,b.cpp
+#         -DSTANDARDS=11,14,17,20 -DEXTRA_FLAGS=... -DOUTPUT=... -P VectorizationReport.cmake
+
+cmake_minimum_required(VERSION 3.16)
+
+foreach(var CXX CXX_ID SOURCE_DIR SOURCES STANDARDS OUTPUT)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "VectorizationReport: -D${var}=... is required")
+    endif()
+endforeach()
+
+string(REPLACE "," ";" SOURCES "${SOURCES}")
+string(REPLACE "," ";" STANDARDS "${STANDARDS}")
+string(REPLACE "," ";" EXTRA_FLAGS "${EXTRA_FLAGS}")
+
+if(CXX_ID STREQUAL "GNU")
+    set(REMARK_FLAGS -fopt-info-vec-optimized -fopt-info-vec-missed)
+elseif(CXX_ID MATCHES "Clang")
+    set(REMARK_FLAGS -Rpass=loop-vectorize -Rpass-missed=loop-vectorize -Rpass-analysis=loop-vectorize)
+else()
+    message(FATAL_ERROR "VectorizationReport: unsupported compiler '${CXX_ID}' (GNU or Clang required)")
+endif()
+
+# Remark output contains ';', '[' and ']' which would break CMake list handling
+function(sanitize_output text out_var)
+    string(REPLACE "\\" "/" text "${text}")
+    string(REPLACE ";" "," text "${text}")
+    string(REPLACE "[" "(" text "${text}")
+    string(REPLACE "]" ")" text "${text}")
+    string(REPLACE "\n" ";" text "${text}")
+    set(${out_var} "${text}" PARENT_SCOPE)
+endfunction()
+
+# "/usr/include/c++/12/bits/stl_numeric.h" -> "<stl_numeric.h>", demo files stay as-is
+function(short_location file line out_var)
+    get_filename_component(name "${file}" NAME)
+    string(FIND "${file}" "${SOURCE_DIR}/" in_source_dir)
+    if(in_source_dir EQUAL 0)
+        set(${out_var} "${name}:${line}" PARENT_SCOPE)
+    else()
+        set(${out_var} "<${name}>:${line}" PARENT_SCOPE)
+    endif()
+endfunction()
+
+# Lines of `src` that carry a `// must-vectorize` marker and survive
+# preprocessing with these flags, as "file.cpp:line"
+function(compiled_markers src std out_var)
+    set(active "")
+    execute_process(
+        COMMAND ${CXX} -std=c++${std} ${EXTRA_FLAGS} -E -C "${SOURCE_DIR}/${src}"
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE preprocessed
+        ERROR_QUIET
+    )
+    if(result EQUAL 0)
+        sanitize_output("${preprocessed}" pp_lines)
+        set(in_source FALSE)
+        set(current 0)
+        foreach(l IN LISTS pp_lines)
+            if(l MATCHES "^# ([0-9]+) \"([^\"]*)\"")
+                set(current ${CMAKE_MATCH_1})
+                if(CMAKE_MATCH_2 STREQUAL "${SOURCE_DIR}/${src}")
+                    set(in_source TRUE)
+                else()
+                    set(in_source FALSE)
+                endif()
+                continue()
+            endif()
+            if(in_source AND l MATCHES "// must-vectorize")
+                list(APPEND active "${src}:${current}")
+            endif()
+            math(EXPR current "${current} + 1")
+        endforeach()
+    endif()
+    set(${out_var} "${active}" PARENT_SCOPE)
+endfunction()
+
+# Collect `// must-vectorize` markers as "file.cpp:line"
+set(must_vectorize "")
+foreach(src ${SOURCES})
+    file(READ "${SOURCE_DIR}/${src}" content)
+    set(offset 0)
+    while(TRUE)
+        string(SUBSTRING "${content}" ${offset} -1 rest)
+        string(FIND "${rest}" "// must-vectorize" pos)
+        if(pos EQUAL -1)
+            break()
+        endif()
+        math(EXPR abs_pos "${offset} + ${pos}")
+        string(SUBSTRING "${content}" 0 ${abs_pos} prefix)
+        string(REGEX MATCHALL "\n" newlines "${prefix}")
+        list(LENGTH newlines line)
+        math(EXPR line "${line} + 1")
+        list(APPEND must_vectorize "${src}:${line}")
+        math(EXPR offset "${abs_pos} + 1")
+    endwhile()
+endforeach()
+
+set(report "")
+string(APPEND report "| Source | C++ | Loop (file:line) | Vectorized | Width | Reason missed |\n")
+string(APPEND report "|--------|-----|------------------|------------|-------|---------------|\n")
+set(regressions "")
+set(unverified "")
+set(total_loops 0)
+set(total_vectorized 0)
+
+foreach(src ${SOURCES})
+    foreach(std ${STANDARDS})
+        execute_process(
+            COMMAND ${CXX} -std=c++${std} -O2 ${EXTRA_FLAGS} ${REMARK_FLAGS}
+                    -c "${SOURCE_DIR}/${src}" -o "${CMAKE_CURRENT_BINARY_DIR}/vectorization_report.o"
+            RESULT_VARIABLE result
+            OUTPUT_VARIABLE stdout_text
+            ERROR_VARIABLE remark_text
+        )
+        if(NOT result EQUAL 0)
+            string(APPEND report "| ${src} | ${std} | - | not built for C++${std} | | |\n")
+            continue()
+        endif()
+
+        sanitize_output("${stdout_text}\n${remark_text}" lines)
+
+        # Per-location counters: one loop may be instantiated/inlined many times
+        set(locations "")
+        set(pending_location "")
+        foreach(l IN LISTS lines)
+            set(location "")
+            set(kind "")
+            if(CXX_ID STREQUAL "GNU")
+                if(l MATCHES "^(.+):([0-9]+):[0-9]+: optimized: loop vectorized using ([0-9]+) byte vectors")
+                    set(kind "yes")
+                    set(width "${CMAKE_MATCH_3}B")
+                elseif(l MATCHES "^(.+):([0-9]+):[0-9]+: missed: couldn't vectorize loop")
+                    set(kind "no")
+                elseif(l MATCHES "^(.+):([0-9]+):[0-9]+: missed: not vectorized: (.*)$" AND pending_location)
+                    set(reason_${pending_location} "${CMAKE_MATCH_3}")
+                    set(pending_location "")
+                endif()
+            else()
+                if(l MATCHES "^(.+):([0-9]+):[0-9]+: remark: vectorized loop \\(vectorization width: ([0-9]+)")
+                    set(kind "yes")
+                    set(width "${CMAKE_MATCH_3} lanes")
+                elseif(l MATCHES "^(.+):([0-9]+):[0-9]+: remark: loop not vectorized: (.*)$")
+                    set(kind "no")
+                    set(clang_reason "${CMAKE_MATCH_3}")
+                endif()
+            endif()
+            if(kind STREQUAL "")
+                continue()
+            endif()
+
+            short_location("${CMAKE_MATCH_1}" "${CMAKE_MATCH_2}" location)
+            string(MAKE_C_IDENTIFIER "${location}" id)
+            if(NOT DEFINED yes_${id})
+                list(APPEND locations "${location}")
+                set(yes_${id} 0)
+                set(no_${id} 0)
+                set(width_${id} "")
+                set(reason_${id} "")
+            endif()
+            if(kind STREQUAL "yes")
+                math(EXPR yes_${id} "${yes_${id}} + 1")
+                set(width_${id} "${width}")
+            else()
+                math(EXPR no_${id} "${no_${id}} + 1")
+                if(CXX_ID STREQUAL "GNU")
+                    set(pending_location "${id}")
+                elseif(reason_${id} STREQUAL "")
+                    set(reason_${id} "${clang_reason}")
+                endif()
+            endif()
+        endforeach()
+
+        list(SORT locations)
+        foreach(location ${locations})
+            string(MAKE_C_IDENTIFIER "${location}" id)
+            math(EXPR total_loops "${total_loops} + 1")
+            if(no_${id} EQUAL 0)
+                set(status "Y")
+                math(EXPR total_vectorized "${total_vectorized} + 1")
+            elseif(yes_${id} EQUAL 0)
+                set(status "N")
+            else()
+                set(status "partial (${yes_${id}}/${no_${id}})")
+            endif()
+            set(mark "")
+            list(FIND must_vectorize "${location}" marked)
+            if(NOT marked EQUAL -1)
+                set(mark " (must)")
+                if(NOT status STREQUAL "Y")
+                    list(APPEND regressions "${location} C++${std}: ${status} - ${reason_${id}}")
+                endif()
+            endif()
+            string(APPEND report "| ${src} | ${std} | ${location}${mark} | ${status} | ${width_${id}} | ${reason_${id}} |\n")
+            unset(yes_${id})
+        endforeach()
+
+        # Marked loops of this file that produced no remark at all: a failure when
+        # the line is compiled, informational inside an inactive #if branch
+        set(silent "")
+        foreach(marker ${must_vectorize})
+            if(marker MATCHES "^${src}:")
+                list(FIND locations "${marker}" seen)
+                if(seen EQUAL -1)
+                    list(APPEND silent "${marker}")
+                endif()
+            endif()
+        endforeach()
+        if(silent)
+            compiled_markers("${src}" "${std}" active)
+            foreach(marker ${silent})
+                list(FIND active "${marker}" compiled)
+                if(compiled EQUAL -1)
+                    list(APPEND unverified "${marker} C++${std}")
+                else()
+                    list(APPEND regressions "${marker} C++${std}: no vectorizer remark - marker not on a loop, or loop removed/unrolled")
+                endif()
+            endforeach()
+        endif()
+    endforeach()
+endforeach()
+
+string(APPEND report "\nLoops with remarks: ${total_loops}, fully vectorized: ${total_vectorized}\n")
+string(REPLACE ";" ", " must_vectorize_text "${must_vectorize}")
+string(APPEND report "must-vectorize markers: ${must_vectorize_text}\n")
+if(unverified)
+    string(REPLACE ";" "\n  " unverified_text "${unverified}")
+    string(APPEND report "Marked loops not compiled in this configuration (inactive #if branch):\n  ${unverified_text}\n")
+endif()
+
+file(WRITE "${OUTPUT}" "${report}")
+message("${report}")
+message("Report written to ${OUTPUT}")
+
+if(regressions)
+    string(REPLACE ";" "\n  " regression_text "${regressions}")
+    message(FATAL_ERROR "must-vectorize loops were not vectorized:\n  ${regression_text}")
+endif()
@@ -0,0 +1,415 @@
+/**
+ * tools/sampling_profiler.cpp
+ *
+ * PURPOSE: In-process sampling profiler that is linked into every performance
+ * demo when the project is configured with -DLAMBDA_SAMPLING_PROFILER=ON.
+ * It does nothing unless LAMBDA_PROFILE is set at run time:
+ *
+ *   LAMBDA_PROFILE=pipeline.folded ./05_expression_template_placeholders_cpp17
+ *   flamegraph.pl pipeline.folded > pipeline.svg       # or speedscope.app
+ *
+ * HOW IT WORKS:
+ *   1. setitimer(ITIMER_PROF) delivers SIGPROF every 1/LAMBDA_PROFILE_HZ
+ *      seconds of process CPU time (default 997 Hz, prime to avoid aliasing
+ *      with periodic work) to whichever thread is running.
+ *   2. The handler walks the frame-pointer chain from the interrupted
+ *      registers (the targets are built with -fno-omit-frame-pointer).
+ *      Only async-signal-safe work happens here: no locks, no allocation.
+ *   3. Stacks are hashed and counted in a fixed-size, open-addressing,
+ *      lock-free table (CAS to claim a slot, fetch_add to count).
+ *   4. At exit the table is symbolized (dladdr, then the module's own ELF
+ *      .symtab for static functions and lambdas, then demangling) and written
+ *      in folded-stack format: "main;benchmark_pipeline;et::sum_if<...> 42".
+ *
+ * LIMITATIONS:
+ *   - Frames of code built without frame pointers (libstdc++, libc) are
+ *     skipped or end the walk. The walk must move strictly upwards and stay
+ *     inside the interrupted thread's stack: the main thread's top comes
+ *     from /proc/self/maps at start-up and its bottom from RLIMIT_STACK (the
+ *     mapping grows downwards on demand), other threads record theirs with
+ *     pthread_getattr_np in a pthread_create wrapper before user code runs.
+ *     A thread with unknown bounds contributes its leaf frame only.
+ *   - ITIMER_PROF is checked on the kernel's scheduler tick, so at most one
+ *     SIGPROF arrives per tick per process: with CONFIG_HZ=250 a 997 Hz request
+ *     yields about 250 samples per CPU second. The exit summary prints the
+ *     rate actually achieved.
+ *   - Functions inlined into their caller are attributed to the caller.
+ *     Stripped modules (usually libc) show up as [libc.so.6+0x...].
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+constexpr std::size_t kSlots = 1u << 13;                  // Distinct stacks
+
+struct Slot {
+    std::atomic<std::uint64_t> key{0};        // 0 = empty, otherwise stack hash
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<int> depth{0};                // Published after frames[] is written
+    std::uintptr_t frames[kMaxDepth];         // Leaf first
+};
+
+Slot g_table[kSlots];
+std::atomic<bool> g_running{false};
+std::atomic<std::uint64_t> g_samples{0};
+std::atomic<std::uint64_t> g_dropped{0};
+
+// [low, high) of this thread's stack; zero until known. Constant-initialized,
+// so the signal handler reads them without running TLS initializers
+thread_local std::uintptr_t t_stack_low = 0;
+thread_local std::uintptr_t t_stack_high = 0;
+
+void record_thread_stack() {
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) return;
+    void* base = nullptr;
+    std::size_t size = 0;
+    if (pthread_attr_getstack(&attr, &base, &size) == 0) {
+        t_stack_low = reinterpret_cast<std::uintptr_t>(base);
+        t_stack_high = t_stack_low + size;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// The main thread's stack ends where the mapping holding the current stack
+// pointer ends; it may grow down to RLIMIT_STACK below that
+void record_main_stack() {
+    const std::uintptr_t here = reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0));
+    std::FILE* maps = std::fopen("/proc/self/maps", "r");
+    if (!maps) return;
+    char line[512];
+    while (std::fgets(line, sizeof(line), maps)) {
+        unsigned long long low = 0, high = 0;
+        if (std::sscanf(line, "%llx-%llx", &low, &high) == 2 && low <= here && here < high) {
+            t_stack_low = static_cast<std::uintptr_t>(low);
+            t_stack_high = static_cast<std::uintptr_t>(high);
+            struct rlimit limit;
+            if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < high) {
+                t_stack_low = std::min(t_stack_low, static_cast<std::uintptr_t>(high - limit.rlim_cur));
+            }
+            break;
+        }
+    }
+    std::fclose(maps);
+}
+
+std::uint64_t hash_stack(const std::uintptr_t* frames, int depth) {
+    std::uint64_t h = 1469598103934665603ull;               // FNV-1a
+    for (int i = 0; i < depth; ++i) {
+        h ^= static_cast<std::uint64_t>(frames[i]);
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+void record_stack(const std::uintptr_t* frames, int depth) {
+    const std::uint64_t h = hash_stack(frames, depth);
+    for (std::size_t probe = 0; probe < kSlots; ++probe) {
+        Slot& slot = g_table[(h + probe) & (kSlots - 1)];
+        std::uint64_t key = slot.key.load(std::memory_order_acquire);
+        if (key == 0) {
+            std::uint64_t expected = 0;
+            if (slot.key.compare_exchange_strong(expected, h, std::memory_order_acq_rel)) {
+                std::memcpy(slot.frames, frames, sizeof(std::uintptr_t) * depth);
+                slot.depth.store(depth, std::memory_order_release);
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            key = expected;   // Another sample claimed it first
+        }
+        if (key == h) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void on_sigprof(int, siginfo_t*, void* context) {
+    if (!g_running.load(std::memory_order_relaxed)) return;
+    const int saved_errno = errno;
+
+    const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+    std::uintptr_t pc, fp, sp;
+#if defined(__x86_64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+    sp = static_cast<std::uintptr_t>(uc->uc_mcontext.gregs[REG_RSP]);
+#elif defined(__aarch64__)
+    pc = static_cast<std::uintptr_t>(uc->uc_mcontext.pc);
+    fp = static_cast<std::uintptr_t>(uc->uc_mcontext.regs[29]);
+    sp = static_cast<std::uintptr_t>(uc->uc_mcontext.sp);
+#else
+#error "sampling_profiler: unsupported architecture (x86-64 or AArch64 required)"
+#endif
+
+    std::uintptr_t frames[kMaxDepth];
+    int depth = 0;
+    frames[depth++] = pc;
+    // Each frame: [fp] = caller's fp, [fp + 8] = return address; both words
+    // must lie in [sp, stack end) of this thread
+    const std::uintptr_t high = t_stack_high;
+    while (depth < kMaxDepth && fp >= sp && fp >= t_stack_low && fp < high && high - fp >= 2 * sizeof(void*) &&
+           (fp % sizeof(void*)) == 0) {
+        const std::uintptr_t* frame = reinterpret_cast<const std::uintptr_t*>(fp);
+        const std::uintptr_t next = frame[0];
+        const std::uintptr_t ret = frame[1];
+        if (ret == 0) break;
+        frames[depth++] = ret - 1;   // Point into the call instruction for symbolization
+        if (next <= fp) break;
+        fp = next;
+    }
+
+    record_stack(frames, depth);
+    g_samples.fetch_add(1, std::memory_order_relaxed);
+    errno = saved_errno;
+}
+
+// Function symbols of one module, read from its .symtab (falls back to .dynsym)
+class ElfSymbols {
+public:
+    explicit ElfSymbols(const char* path) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file) return;
+        std::vector<char> image;
+        char buffer[1 << 16];
+        std::size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) image.insert(image.end(), buffer, buffer + n);
+        std::fclose(file);
+        if (image.size() < sizeof(Elf64_Ehdr) || std::memcmp(image.data(), ELFMAG, SELFMAG) != 0 ||
+            image[EI_CLASS] != ELFCLASS64) {
+            return;
+        }
+
+        const Elf64_Ehdr* header = reinterpret_cast<const Elf64_Ehdr*>(image.data());
+        position_independent_ = header->e_type == ET_DYN;
+        if (header->e_shoff == 0 || header->e_shoff + header->e_shnum * sizeof(Elf64_Shdr) > image.size()) return;
+        const Elf64_Shdr* sections = reinterpret_cast<const Elf64_Shdr*>(image.data() + header->e_shoff);
+
+        for (Elf64_Word wanted : {static_cast<Elf64_Word>(SHT_SYMTAB), static_cast<Elf64_Word>(SHT_DYNSYM)}) {
+            for (int i = 0; i < header->e_shnum; ++i) {
+                const Elf64_Shdr& table = sections[i];
+                if (table.sh_type != wanted || table.sh_link >= header->e_shnum) continue;
+                const Elf64_Shdr& strings = sections[table.sh_link];
+                if (table.sh_offset + table.sh_size > image.size() || strings.sh_offset + strings.sh_size > image.size()) continue;
+                const Elf64_Sym* symbols = reinterpret_cast<const Elf64_Sym*>(image.data() + table.sh_offset);
+                const std::size_t count = table.sh_size / sizeof(Elf64_Sym);
+                for (std::size_t s = 0; s < count; ++s) {
+                    const Elf64_Sym& sym = symbols[s];
+                    if (ELF64_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_value == 0 || sym.st_name >= strings.sh_size) continue;
+                    functions_.push_back({sym.st_value, sym.st_size, image.data() + strings.sh_offset + sym.st_name});
+                }
+            }
+            if (!functions_.empty()) break;
+        }
+        std::sort(functions_.begin(), functions_.end(),
+                  [](const Function& a, const Function& b) { return a.start < b.start; });
+    }
+
+    // Returns nullptr when the address is not inside a known function
+    const std::string* find(std::uintptr_t address, std::uintptr_t module_base) const {
+        const std::uint64_t offset = position_independent_ ? address - module_base : address;
+        auto it = std::upper_bound(functions_.begin(), functions_.end(), offset,
+                                   [](std::uint64_t value, const Function& f) { return value < f.start; });
+        if (it == functions_.begin()) return nullptr;
+        --it;
+        if (offset >= it->start + std::max<std::uint64_t>(it->size, 1)) return nullptr;
+        return &it->name;
+    }
+
+private:
+    struct Function {
+        std::uint64_t start;
+        std::uint64_t size;
+        std::string name;
+    };
+    std::vector<Function> functions_;
+    bool position_independent_ = false;
+};
+
+std::string demangle(const char* symbol) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+    std::string name = (status == 0 && demangled) ? demangled : symbol;
+    std::free(demangled);
+    return name;
+}
+
+std::string symbolize(std::uintptr_t address, std::map<std::uintptr_t, std::string>& cache,
+                      std::map<std::string, ElfSymbols>& modules) {
+    auto it = cache.find(address);
+    if (it != cache.end()) return it->second;
+
+    std::string name;
+    Dl_info info;
+    std::memset(&info, 0, sizeof(info));
+    const bool found = dladdr(reinterpret_cast<void*>(address), &info) != 0;
+    const std::string* elf_name = nullptr;
+    if (found && info.dli_fname) {
+        auto module = modules.find(info.dli_fname);
+        if (module == modules.end()) module = modules.emplace(info.dli_fname, ElfSymbols(info.dli_fname)).first;
+        elf_name = module->second.find(address, reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+    }
+
+    if (elf_name) {
+        name = demangle(elf_name->c_str());
+    } else if (found && info.dli_sname) {
+        name = demangle(info.dli_sname);
+    } else if (found && info.dli_fname) {
+        const char* base = std::strrchr(info.dli_fname, '/');
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "+0x%zx",
+                      static_cast<std::size_t>(address - reinterpret_cast<std::uintptr_t>(info.dli_fbase)));
+        name = std::string("[") + (base ? base + 1 : info.dli_fname) + buffer + "]";
+    } else {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "[0x%zx]", static_cast<std::size_t>(address));
+        name = buffer;
+    }
+    // ';' separates frames in the folded format
+    for (char& ch : name) {
+        if (ch == ';') ch = ':';
+    }
+    cache.emplace(address, name);
+    return name;
+}
+
+class SamplingProfiler {
+public:
+    SamplingProfiler() {
+        const char* path = std::getenv("LAMBDA_PROFILE");
+        if (!path || !*path) return;
+        output_path_ = path;
+
+        long hz = 997;
+        if (const char* env_hz = std::getenv("LAMBDA_PROFILE_HZ")) hz = std::strtol(env_hz, nullptr, 10);
+        if (hz <= 0 || hz > 100000) hz = 997;
+
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = on_sigprof;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            std::perror("sampling_profiler: sigaction");
+            return;
+        }
+
+        record_main_stack();
+        start_cpu_seconds_ = cpu_seconds();
+        g_running.store(true, std::memory_order_relaxed);
+        struct itimerval timer;
+        timer.it_interval.tv_sec = 0;
+        timer.it_interval.tv_usec = static_cast<suseconds_t>(1000000 / hz);
+        timer.it_value = timer.it_interval;
+        if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+            std::perror("sampling_profiler: setitimer");
+            g_running.store(false);
+            return;
+        }
+        active_ = true;
+        std::fprintf(stderr, "[sampling_profiler] %ld Hz -> %s\n", hz, output_path_.c_str());
+    }
+
+    ~SamplingProfiler() {
+        if (!active_) return;
+        struct itimerval off;
+        std::memset(&off, 0, sizeof(off));
+        setitimer(ITIMER_PROF, &off, nullptr);
+        g_running.store(false, std::memory_order_relaxed);
+        write_folded();
+    }
+
+private:
+    static double cpu_seconds() {
+        struct timespec now;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0) return 0;
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) * 1e-9;
+    }
+
+    void write_folded() const {
+        std::FILE* out = std::fopen(output_path_.c_str(), "w");
+        if (!out) {
+            std::perror("sampling_profiler: fopen");
+            return;
+        }
+        std::map<std::uintptr_t, std::string> cache;
+        std::map<std::string, ElfSymbols> modules;
+        // Distinct return addresses can symbolize to the same line; merge their counts
+        std::map<std::string, std::uint64_t> folded;
+        for (const Slot& slot : g_table) {
+            const int depth = slot.depth.load(std::memory_order_acquire);
+            const std::uint64_t count = slot.count.load(std::memory_order_relaxed);
+            if (depth == 0 || count == 0) continue;
+            std::string line;
+            for (int i = depth - 1; i >= 0; --i) {   // Folded format is root first
+                line += symbolize(slot.frames[i], cache, modules);
+                if (i) line += ';';
+            }
+            folded[line] += count;
+        }
+        for (const auto& entry : folded) {
+            std::fprintf(out, "%s %llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+        }
+        std::fclose(out);
+        const std::uint64_t samples = g_samples.load();
+        const double cpu = cpu_seconds() - start_cpu_seconds_;
+        std::fprintf(stderr, "[sampling_profiler] %llu samples (%.0f per CPU second), %zu distinct stacks, %llu dropped -> %s\n",
+                     static_cast<unsigned long long>(samples), cpu > 0 ? static_cast<double>(samples) / cpu : 0.0,
+                     folded.size(), static_cast<unsigned long long>(g_dropped.load()), output_path_.c_str());
+    }
+
+    std::string output_path_;
+    double start_cpu_seconds_ = 0;
+    bool active_ = false;
+};
+
+// Started before main() and flushed after it returns
+SamplingProfiler g_profiler;
+
+struct ThreadStart {
+    void* (*routine)(void*);
+    void* arg;
+};
+
+void* start_with_stack_bounds(void* raw) {
+    const ThreadStart start = *static_cast<ThreadStart*>(raw);
+    delete static_cast<ThreadStart*>(raw);
+    record_thread_stack();
+    return start.routine(start.arg);
+}
+
+}  // namespace
+
+// Wraps std::thread's (and everyone's) pthread_create while profiling, so each
+// new thread records its stack bounds before running user code
+extern "C" int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*routine)(void*), void* arg) {
+    using Create = int (*)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+    static const Create real = reinterpret_cast<Create>(dlsym(RTLD_NEXT, "pthread_create"));
+    if (!g_running.load(std::memory_order_relaxed)) return real(thread, attr, routine, arg);
+    ThreadStart* start = new ThreadStart{routine, arg};
+    const int result = real(thread, attr, start_with_stack_bounds, start);
+    if (result != 0) delete start;
+    return result;
+}